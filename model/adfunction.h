@@ -0,0 +1,78 @@
+/***************************************************************************
+                          adfunction.h  -  vectorfunction with exact jacobian
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ADFUNCTION_H
+#define ADFUNCTION_H
+
+#include "vectorfunction.h"
+#include "dual.h"
+
+namespace MODEL {
+
+  /** Base class for a VectorFunction that gets its jacobian by
+	  automatic differentiation. Instead of function(), write the
+	  equations once as a template, for any kind of vector:
+
+	  \code
+	  class MyModel : public ADFunction<MyModel,2>
+	  {
+	  public:
+	    template <class V>
+	    const V& evaluate(V& f, const V& u)
+	    { f[0]=-u[0]+a*u[1]; f[1]=u[0]*u[1]; return f; }
+		...
+	  };
+	  \endcode
+
+	  function() calls it with the normal vectors; jacobian() calls it
+	  once with vectors of Dual numbers, which gives the exact
+	  jacobian for about the price of dims evaluations - but without
+	  the step size (and the error) of finite differences. Parameters
+	  stay plain numbers, so get_parameter() and friends work as usual.
+  */
+  template <class Model, integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class ADFunction : public VectorFunction<dims,nelem,NT>
+  {
+  public:
+	typedef VectorFunction<dims,nelem,NT>		base;
+	typedef typename base::numT					numT;
+	typedef typename base::vect					vect;
+	typedef typename base::matrix				matrix;
+
+	/** The scalar and vector the jacobian is calculated with */
+	typedef Dual<numT,dims>									dual;
+	typedef typename NumericTraits<dual,dims>::vect			dvect;
+
+	virtual const vect& function(vect& fu,const vect& u)
+	{
+	  return static_cast<Model*>(this)->evaluate(fu,u);
+	}
+
+	virtual bool jacobian(matrix& j, const vect& u)
+	{
+	  dvect	du,dfu;
+	  for (integer k=0;k<dims;k++) du[k]=dual(u[k],k);
+	  static_cast<Model*>(this)->evaluate(dfu,du);
+	  for (integer i=0;i<dims;i++)
+		for (integer k=0;k<dims;k++)
+		  j[i][k]=dfu[i].derivative(k);
+	  return true;
+	}
+  };
+
+} // end namespace MODEL
+#endif
@@ -0,0 +1,137 @@
+/***************************************************************************
+                          asyncwriter.cpp  -  probe output on its own thread
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "asyncwriter.h"
+#include <chrono>
+#include <stdexcept>
+
+namespace MODEL
+{
+  using namespace std;
+
+  AsyncProbeWriter::AsyncProbeWriter(ProbeWriter& t, counter capacity)
+	: target(&t), head(0), tail(0), stop(false), failed(false),
+	  reported(false), waits(0)
+  {
+	counter size=2;
+	while(size<capacity) size*=2;
+	ring.resize(size);
+	mask=size-1;
+	worker=std::thread(&AsyncProbeWriter::run,this);
+  }
+
+  AsyncProbeWriter::~AsyncProbeWriter()
+  {
+	stop=true;
+	wake.notify_one();
+	worker.join();
+	if(!failed) 
+	  try {target->finish();} catch(...) {}
+  }
+
+  void
+  AsyncProbeWriter::write(const number* d, counter n)
+  {
+	if(failed) {check(); return;} // nobody left to write it
+	const counter size=ring.size();
+	if(n+1>size) throw std::logic_error("AsyncProbeWriter::Record larger than the buffer");
+
+	const counter h=head.load(memory_order_relaxed);
+	if(size-(h-tail.load(memory_order_acquire))<n+1)
+	  {
+		// back-pressure: wait for the thread to make room
+		++waits;
+		do
+		  {
+			wake.notify_one();
+			std::this_thread::yield();
+			if(failed) {check(); return;}
+		  }
+		while(size-(h-tail.load(memory_order_acquire))<n+1);
+	  }
+
+	ring[h&mask]=n;
+	for(counter i=0;i<n;i++) ring[(h+1+i)&mask]=d[i];
+	head.store(h+n+1,memory_order_release);
+  }
+
+  void
+  AsyncProbeWriter::finish(void)
+  {
+	while(!failed && tail.load(memory_order_acquire)!=head.load(memory_order_relaxed))
+	  {
+		wake.notify_one();
+		unique_lock<mutex> lock(m);
+		drained.wait_for(lock,chrono::milliseconds(1));
+	  }
+	if(failed) check();
+	else target->finish();
+  }
+
+  void
+  AsyncProbeWriter::check(void)
+  {
+	// only once: the records after it are lost anyway
+	if(failed && !reported)
+	  {
+		reported=true;
+		rethrow_exception(error);
+	  }
+  }
+
+  bool
+  AsyncProbeWriter::drain(void)
+  {
+	counter t=tail.load(memory_order_relaxed);
+	const counter h=head.load(memory_order_acquire);
+	if(t==h) return false;
+	while(t!=h)
+	  {
+		const counter n=static_cast<counter>(ring[t&mask]);
+		record.resize(n);
+		for(counter i=0;i<n;i++) record[i]=ring[(t+1+i)&mask];
+		target->write((n>0)?&record[0]:NULL,n);
+		t+=n+1;
+		// give the room back record by record
+		tail.store(t,memory_order_release);
+	  }
+	return true;
+  }
+
+  void
+  AsyncProbeWriter::run(void)
+  {
+	try
+	  {
+		for(;;)
+		  {
+			if(drain()) continue;
+			drained.notify_all();
+			if(stop) {drain(); break;}
+			unique_lock<mutex> lock(m);
+			wake.wait_for(lock,chrono::milliseconds(1));
+		  }
+	  }
+	catch(...)
+	  {
+		error=current_exception();
+		failed=true;
+	  }
+	drained.notify_all();
+  }
+
+} // end namespace
@@ -0,0 +1,91 @@
+/***************************************************************************
+                          asyncwriter.h  -  probe output on its own thread
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include "probe.h"
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace MODEL {
+
+  /** A ProbeWriter which hands the records to another writer on a
+	  thread of its own, so the formatting and the disk are not on the
+	  integration thread:
+
+	  \code
+	  BinaryProbeWriter file("run.bin");
+	  AsyncProbeWriter later(file);
+	  ODEProbe<2> p(T,sys,later);
+	  \endcode
+
+	  The probe copies each record into a ring buffer (one producer,
+	  one consumer, no locks) and goes on. Only when the buffer is full
+	  does it wait for the thread to make room: size it so that does
+	  not happen, get_waits() tells you if it did. finish() (called by
+	  the Probe destructor) and the destructor wait until everything
+	  has been handed over, and then finish the target.
+
+	  One probe per AsyncProbeWriter, and the target should not be
+	  used by anyone else while the thread runs. If the target throws,
+	  the next write() or finish() throws it again (once); records
+	  after that are dropped.
+  */
+  class AsyncProbeWriter : public ProbeWriter
+  {
+  public:
+	/** @param target the writer that does the actual work
+		@param capacity the size of the ring buffer in numbers (rounded
+		up to a power of two); a record takes one more than its length */
+	AsyncProbeWriter(ProbeWriter& target, counter capacity=1<<16);
+	~AsyncProbeWriter();
+
+	virtual void write(const number* d, counter n);
+	virtual void finish(void);
+
+	/** How many times a write() had to wait for room */
+	counter get_waits(void) const {return waits;}
+
+  private:
+	void run(void);
+	bool drain(void);
+	void check(void);
+
+	ProbeWriter*		target;
+	std::vector<number>	ring;
+	counter				mask;
+	/** Positions, only ever increasing: head is written by the probe,
+		tail by the thread */
+	std::atomic<counter>	head,tail;
+	std::atomic<bool>		stop,failed;
+	std::exception_ptr		error;
+	bool					reported;
+	counter					waits;
+	/** Only used to sleep on */
+	std::mutex				m;
+	std::condition_variable	wake,drained;
+	std::vector<number>		record;
+	std::thread				worker;
+  };
+
+} // end namespace MODEL
+#endif
@@ -0,0 +1,398 @@
+/***************************************************************************
+                          continuation.h  -  following branches of roots
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef CONTINUATION_H
+#define CONTINUATION_H
+
+#include "rootscan.h"
+#include "modelinstance.h"
+#include "lusolve.h"
+#include <vector>
+#include <complex>
+
+namespace MODEL
+{
+  /** Pseudo-arclength continuation: follows one branch of roots of
+	  f(u,p)=0 as the parameter p changes, and finds the folds and
+	  Hopf points on it.
+
+	  RootScan solves from scratch at every parameter value, from every
+	  starter, and cannot go round a fold. Here the branch is a curve
+	  x(s)=(u(s),p(s)) parametrised by its length s: every step
+	  predicts along the tangent and corrects with Newton on the
+	  dims+1 equations
+	  \code
+	  f(u,p)=0,   t.(x-x_prev)=ds
+	  \endcode
+	  which stay regular at a fold. A point costs a few Newton steps
+	  (usually two or three) and one eigenvalue decomposition.
+
+	  The step ds grows when the corrector converges quickly and the
+	  tangent hardly turns, and shrinks when it does not. A fold shows
+	  up as a change of sign of dp/ds, a Hopf point as a change in the
+	  number of complex eigenvalues with a positive real part, and a
+	  branch point as a real eigenvalue going through zero anywhere
+	  else. They are located by interpolation between the two points
+	  around them: good to about the square of the step.
+
+	  The result is a ScanList like the one RootScan returns (root,
+	  real and imaginary parts of the eigenvalues), so select() and
+	  print_list() work on it.
+
+	  \code
+	  Continuation<2> c(vcsel,"current");
+	  ScanList<2> branch=c.follow(start,0.,6.);
+	  \endcode
+  */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class Continuation
+  {
+  public:
+	typedef typename NT::number numT;
+	typedef typename NT::vf vf;
+	typedef typename NT::vect vect;
+	typedef typename NT::matrix matrix;
+	/** The extended system: dims variables and the parameter */
+	typedef NumericTraits<nelem,dims+1>	XNT;
+	typedef typename XNT::vect xvect;
+	typedef typename XNT::matrix xmatrix;
+
+	/** What kind of special point: a fold (the branch turns back), a
+		Hopf point, or a branch point (a real eigenvalue goes through
+		zero without a fold: another branch crosses this one) */
+	enum Kind {Fold, Hopf, Branch};
+
+	/** A special point on the branch */
+	struct Bifurcation
+	{
+	  Kind	kind;
+	  numT	param;
+	  vect	point;
+	};
+
+	/** With own, work on a ModelInstance (see RootScan) */
+	Continuation(vf& tobefollowed, const string& param, bool own=false) :
+	  mine((own)?new ModelInstance<dims,nelem,NT>(tobefollowed):NULL),
+	  f((own)?&mine->get_function():&tobefollowed),
+	  p(&f->get_parameter(param)), J(*f,Precision<numT>::sqrt_tolerance(1E-6)),
+	  ds(Precision<numT>::sqrt_tolerance(1E-2)),
+	  dsmin(Precision<numT>::sqrt_tolerance(1E-8)), dsmax(0.5),
+	  maxangle(0.2), tol(Precision<numT>::tolerance(1E-10)), maxit(8) {}
+
+	~Continuation() {delete mine;}
+
+	/** The first step, and the bounds on the step (in arclength) */
+	void set_step(const numT& first, const numT& smallest, const numT& largest)
+	{
+	  ds=first; dsmin=smallest; dsmax=largest;
+	}
+
+	/** How far (in radians) the tangent may turn in one step */
+	void set_max_angle(const numT& a) {maxangle=a;}
+
+	/** Follow the branch through the root near start at p=from, in
+		the direction of p=to, until p leaves [from,to] (the branch may
+		turn back at a fold, and then goes on the other way) or after
+		maxpoints points. Throws if there is no root near start. */
+	const ScanList<dims,nelem,NT>& follow(const vect& start, const numT& from,
+										  const numT& to, counter maxpoints=10000);
+
+	/** The folds and Hopf points found by the last follow() */
+	const std::vector<Bifurcation>& get_bifurcations(void) const {return special;}
+
+	/** The points the last follow() calculated */
+	const ScanList<dims,nelem,NT>& get_branch(void) const {return branch;}
+
+	NO_COPY(Continuation);
+
+  private:
+	/** f at (u,q), and df/dp by central differences */
+	void evaluate(const vect& u, const numT& q, vect& fu, vect& fp)
+	{
+	  const numT h=Precision<numT>::sqrt_tolerance(1E-6)*((abs(q)>1.)?abs(q):numT(1.));
+	  *p=q+h; vect fplus((*f)(u));
+	  *p=q-h; vect fmin((*f)(u));
+	  *p=q;   f->function(fu,u);
+	  for (integer i=0;i<dims;i++) fp[i]=(fplus[i]-fmin[i])/(2.*h);
+	}
+
+	/** The matrix of the extended system: jacobian, df/dp, and t as
+		the last row */
+	static void extend(xmatrix& A, const matrix& j, const vect& fp, const xvect& t)
+	{
+	  for (integer i=0;i<dims;i++)
+		{
+		  for (integer k=0;k<dims;k++) A[i][k]=j[i][k];
+		  A[i][dims]=fp[i];
+		}
+	  for (integer k=0;k<=dims;k++) A[dims][k]=t[k];
+	}
+
+	static numT norm2(const xvect& x)
+	{
+	  numT s=0.;
+	  for (integer k=0;k<=dims;k++) s+=x[k]*x[k];
+	  return sqrt(s);
+	}
+
+	/** The unit tangent at x with the orientation of t */
+	xvect tangent(const xvect& x, const xvect& t);
+
+	/** Newton on the extended system, from the prediction x at
+		distance step from xprev along t. Returns false if it does not
+		converge in maxit steps. */
+	bool correct(xvect& x, const xvect& xprev, const xvect& t, const numT& step, counter& its);
+
+	/** Calculate the stability at x and add it to the branch */
+	void record(const xvect& x, vect& reals, vect& imags);
+
+	/** The determinant of the jacobian: the product of the eigenvalues */
+	static numT determinant(const vect& reals, const vect& imags)
+	{
+	  std::complex<numT> d(1.);
+	  for (integer i=0;i<dims;i++) d*=std::complex<numT>(reals[i],imags[i]);
+	  return d.real();
+	}
+
+	/** The number of complex eigenvalues in the right half plane */
+	static counter unstable_pairs(const vect& reals, const vect& imags)
+	{
+	  counter n=0;
+	  for (integer i=0;i<dims;i++) if (reals[i]>0. && imags[i]!=0.) n++;
+	  return n;
+	}
+
+	/** The real part of the complex pair closest to the imaginary
+		axis; false if there is none */
+	static bool closest_pair(const vect& reals, const vect& imags, numT& re)
+	{
+	  bool found=false;
+	  for (integer i=0;i<dims;i++)
+		if (imags[i]!=0. && (!found || abs(reals[i])<abs(re)))
+		  {
+			re=reals[i];
+			found=true;
+		  }
+	  return found;
+	}
+
+	/** A special point at fraction w of the way from a to b */
+	void add_special(Kind k, const xvect& a, const xvect& b, const numT& w)
+	{
+	  add_special(k,a,b,w,a[dims]+w*(b[dims]-a[dims]));
+	}
+
+	void add_special(Kind k, const xvect& a, const xvect& b, const numT& w, const numT& q)
+	{
+	  Bifurcation bif;
+	  bif.kind=k;
+	  bif.param=q;
+	  for (integer i=0;i<dims;i++) bif.point[i]=a[i]+w*(b[i]-a[i]);
+	  special.push_back(bif);
+	}
+
+	ModelInstance<dims,nelem,NT>* mine;
+	vf*		f;
+	/** parameters are plain numbers, whatever numT is */
+	number*	p;
+	Jacobian<dims,NT>	J;
+
+	numT	ds,dsmin,dsmax,maxangle,tol;
+	counter	maxit;
+
+	ScanList<dims,nelem,NT>	branch;
+	std::vector<Bifurcation>	special;
+  };
+
+  //------------------------------------------------------------
+
+  template<integer dims, typename nelem, class NT >
+  typename Continuation<dims,nelem,NT>::xvect
+  Continuation<dims,nelem,NT>::tangent(const xvect& x, const xvect& t)
+  {
+	vect u,fu,fp;
+	for (integer i=0;i<dims;i++) u[i]=x[i];
+	*p=x[dims];
+	evaluate(u,x[dims],fu,fp);
+	matrix j=J.calculate(u,fu);
+
+	// [J fp; t] tn = [0 ... 0 1]: tn is tangent to the branch, and
+	// t.tn=1 keeps the direction
+	xmatrix A;
+	extend(A,j,fp,t);
+	xvect tn(0.);
+	tn[dims]=1.;
+	LUSolve<dims+1,XNT> lu(A);
+	lu.solve(tn);
+	const numT l=norm2(tn);
+	for (integer k=0;k<=dims;k++) tn[k]/=l;
+	return tn;
+  }
+
+  template<integer dims, typename nelem, class NT >
+  bool Continuation<dims,nelem,NT>::correct(xvect& x, const xvect& xprev, const xvect& t,
+											const numT& step, counter& its)
+  {
+	vect u,fu,fp;
+	for (its=1;its<=maxit;its++)
+	  {
+		for (integer i=0;i<dims;i++) u[i]=x[i];
+		evaluate(u,x[dims],fu,fp);
+		matrix j=J.calculate(u,fu);
+
+		xvect r;
+		numT arc=-step;
+		for (integer k=0;k<=dims;k++) arc+=t[k]*(x[k]-xprev[k]);
+		for (integer i=0;i<dims;i++) r[i]=-fu[i];
+		r[dims]=-arc;
+
+		xmatrix A;
+		extend(A,j,fp,t);
+		LUSolve<dims+1,XNT> lu(A);
+		lu.solve(r);
+		for (integer k=0;k<=dims;k++) x[k]+=r[k];
+
+		numT scale=1.;
+		for (integer k=0;k<=dims;k++) if (abs(x[k])>scale) scale=abs(x[k]);
+		if (norm2(r)<tol*scale) return true;
+	  }
+	return false;
+  }
+
+  template<integer dims, typename nelem, class NT >
+  void Continuation<dims,nelem,NT>::record(const xvect& x, vect& reals, vect& imags)
+  {
+	vect u;
+	for (integer i=0;i<dims;i++) u[i]=x[i];
+	*p=x[dims];
+	Eigenvalues<dims,nelem,NT> ev(J.calculate(u));
+	reals=ev.real();
+	imags=ev.imag();
+	branch.add_point(u);
+	branch.add_point(reals);
+	branch.add_point(imags);
+	branch.add_param(x[dims]);
+  }
+
+  template<integer dims, typename nelem, class NT >
+  const ScanList<dims,nelem,NT>&
+  Continuation<dims,nelem,NT>::follow(const vect& start, const numT& from,
+									  const numT& to, counter maxpoints)
+  {
+	branch.clear();
+	special.clear();
+	const numT lo=(from<to)?from:to;
+	const numT hi=(from<to)?to:from;
+
+	// The first root: the usual Newton at fixed p
+	*p=from;
+	NewtonRoot<dims,nelem,NT> stat(*f);
+	vect u=stat(start);
+	if (stat.wrong_min() || stat.no_root())
+	  throw std::logic_error("Continuation::No root near the starting point");
+
+	xvect x;
+	for (integer i=0;i<dims;i++) x[i]=u[i];
+	x[dims]=from;
+
+	// Start off towards "to"
+	xvect t(0.);
+	t[dims]=(to>=from)?1.:-1.;
+	t=tangent(x,t);
+
+	vect reals,imags;
+	record(x,reals,imags);
+	counter pairs=unstable_pairs(reals,imags);
+	numT d=determinant(reals,imags);
+
+	numT step=ds;
+	for (counter n=1;n<maxpoints;n++)
+	  {
+		// predict and correct, smaller steps until it works
+		xvect xn;
+		counter its=0;
+		bool ok=false;
+		while (!ok)
+		  {
+			for (integer k=0;k<=dims;k++) xn[k]=x[k]+step*t[k];
+			ok=correct(xn,x,t,step,its);
+			if (!ok)
+			  {
+				step*=0.5;
+				if (step<dsmin) {*p=x[dims]; return branch;}
+			  }
+		  }
+
+		xvect tn=tangent(xn,t);
+
+		// Too sharp a turn: the step was too large for the curvature
+		numT c=0.;
+		for (integer k=0;k<=dims;k++) c+=t[k]*tn[k];
+		const numT angle=acos((c<1.)?c:numT(1.));
+		if (angle>maxangle && step>dsmin)
+		  {
+			step*=0.5;
+			n--;
+			continue;
+		  }
+
+		if (xn[dims]<lo || xn[dims]>hi) break;
+
+		vect rn,in;
+		record(xn,rn,in);
+
+		// p turned round: a fold between x and xn, where dp/ds=0.
+		// dp/ds is about linear in s there, so p is a parabola
+		const bool fold=((t[dims]>0.)!=(tn[dims]>0.));
+		if (fold)
+		  {
+			const numT w=t[dims]/(t[dims]-tn[dims]);
+			const numT h=norm2(xn-x);
+			add_special(Fold,x,xn,w,x[dims]+0.5*w*h*t[dims]);
+		  }
+
+		// A real eigenvalue went through zero, not at a fold: the
+		// determinant changes sign
+		const numT dn=determinant(rn,in);
+		if (!fold && (d>0.)!=(dn>0.))
+		  add_special(Branch,x,xn,d/(d-dn));
+		d=dn;
+
+		// A complex pair crossed the imaginary axis (and did not just
+		// become two real eigenvalues): interpolate on the real part
+		const counter np=unstable_pairs(rn,in);
+		numT a,b;
+		if (np!=pairs && closest_pair(reals,imags,a) && closest_pair(rn,in,b) && a!=b)
+		  add_special(Hopf,x,xn,a/(a-b));
+		pairs=np;
+		reals=rn; imags=in;
+
+		// Adapt: grow on easy steps, shrink on hard ones
+		if (its<=3 && angle<0.5*maxangle) step*=1.5;
+		else if (its>5) step*=0.7;
+		if (step>dsmax) step=dsmax;
+		if (step<dsmin) step=dsmin;
+
+		x=xn;
+		t=tn;
+	  }
+	*p=x[dims];
+	return branch;
+  }
+
+} // end namespace MODEL
+#endif
@@ -31,12 +31,14 @@ namespace MODEL
   COwner::add_to_list(Cycler& c)
   {
 	c_list.push_front(&c);
+	++generation;
   }
 
   void 
   COwner::remove(Cycler& c)
   {
     c_list.remove(&c);
+	++generation;
 	// slist<Cycler*>::iterator deadboy=find(c_list.begin(),c_list.end(),&c);
 	// if(deadboy!=c_list.end()) c_list.erase_after(deadboy);
 	// else throw(std::logic_error("Tried to remove a cycler that wasn't there in ther first place"));
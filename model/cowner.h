@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include <algorithm>
 #include "cycler.h"
+#include "numerictypes.h"
 
 #ifdef __GNUC__
 // gcc version < 3.1.0 ?
@@ -48,6 +49,7 @@ namespace MODEL
   {
 	friend class Cycler;
   public:
+	COwner() : generation(0) {}
 	/** To make sure all the destructors are called */
 	virtual ~COwner(){}
 	/** Call all Cycler objects */
@@ -61,8 +63,15 @@ namespace MODEL
 	void add_to_list(Cycler& c);
 	void remove(Cycler& c);
 
+	/** The cyclers, in the order execute_list() calls them */
+	const slist<Cycler*>& get_list(void) const {return c_list;}
+	/** Changes every time a cycler is added or removed, so a copy of
+		the list can tell when it is out of date */
+	const counter& get_generation(void) const {return generation;}
+
   private:
 	slist<Cycler*> c_list;
+	counter generation;
   };
 } // end namespace
 
@@ -0,0 +1,126 @@
+/***************************************************************************
+                          dual.h  -  forward mode automatic differentiation
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DUAL_H
+#define DUAL_H
+
+#include "numerictypes.h"
+#include <cmath>
+
+namespace MODEL {
+
+  /** A number that carries its derivatives to n variables along:
+	  x + sum_k d_k.e_k with e_k.e_l = 0. Do the arithmetic on it and
+	  the derivatives come out exact, without any step size. See
+	  ADFunction for the way to get a jacobian out of it.
+
+	  The operators are friends defined in the class, so that mixing
+	  with plain numbers (and with double literals when numT is long
+	  double) converts the way you would expect.
+  */
+  template <typename numT, integer n>
+  class Dual
+  {
+  public:
+	/** A constant: all derivatives zero */
+	Dual(const numT& v=0.) : x(v) {for (integer k=0;k<n;k++) d[k]=0.;}
+
+	/** Variable number k: derivative 1 to itself, 0 to the others */
+	Dual(const numT& v, integer k) : x(v)
+	{for (integer l=0;l<n;l++) d[l]=0.; d[k]=1.;}
+
+	/** The value */
+	const numT&	value(void) const {return x;}
+
+	/** The derivative to variable k */
+	const numT&	derivative(integer k) const {return d[k];}
+
+	const Dual&	operator+=(const Dual& b)
+	{ x+=b.x; for (integer k=0;k<n;k++) d[k]+=b.d[k]; return *this; }
+
+	const Dual&	operator-=(const Dual& b)
+	{ x-=b.x; for (integer k=0;k<n;k++) d[k]-=b.d[k]; return *this; }
+
+	const Dual&	operator*=(const Dual& b)
+	{ for (integer k=0;k<n;k++) d[k]=d[k]*b.x+x*b.d[k]; x*=b.x; return *this; }
+
+	const Dual&	operator/=(const Dual& b)
+	{
+	  const numT r=numT(1.)/b.x;
+	  x*=r;
+	  for (integer k=0;k<n;k++) d[k]=(d[k]-x*b.d[k])*r;
+	  return *this;
+	}
+
+	friend Dual	operator+(Dual a, const Dual& b) {return a+=b;}
+	friend Dual	operator-(Dual a, const Dual& b) {return a-=b;}
+	friend Dual	operator*(Dual a, const Dual& b) {return a*=b;}
+	friend Dual	operator/(Dual a, const Dual& b) {return a/=b;}
+
+	friend Dual	operator-(Dual a)
+	{ a.x=-a.x; for (integer k=0;k<n;k++) a.d[k]=-a.d[k]; return a; }
+	friend Dual	operator+(const Dual& a) {return a;}
+
+	/** Scaling by a plain number is cheaper than a full product */
+	friend Dual	operator*(Dual a, const numT& s)
+	{ a.x*=s; for (integer k=0;k<n;k++) a.d[k]*=s; return a; }
+	friend Dual	operator*(const numT& s, Dual a) {return a*s;}
+	friend Dual	operator/(Dual a, const numT& s) {return a*(numT(1.)/s);}
+
+	/** Comparisons look at the value only */
+	friend bool	operator<(const Dual& a, const Dual& b) {return a.x<b.x;}
+	friend bool	operator>(const Dual& a, const Dual& b) {return a.x>b.x;}
+	friend bool	operator<=(const Dual& a, const Dual& b) {return a.x<=b.x;}
+	friend bool	operator>=(const Dual& a, const Dual& b) {return a.x>=b.x;}
+	friend bool	operator==(const Dual& a, const Dual& b) {return a.x==b.x;}
+	friend bool	operator!=(const Dual& a, const Dual& b) {return a.x!=b.x;}
+
+	/** f(a) for a function with value fx and derivative dfx at a */
+	friend Dual	chain(const Dual& a, const numT& fx, const numT& dfx)
+	{ Dual r(fx); for (integer k=0;k<n;k++) r.d[k]=dfx*a.d[k]; return r; }
+
+	friend Dual	sqrt(const Dual& a)
+	{ const numT s=std::sqrt(a.x); return chain(a,s,numT(0.5)/s); }
+	friend Dual	exp(const Dual& a)
+	{ const numT e=std::exp(a.x); return chain(a,e,e); }
+	friend Dual	log(const Dual& a)
+	{ return chain(a,std::log(a.x),numT(1.)/a.x); }
+	friend Dual	sin(const Dual& a)
+	{ return chain(a,std::sin(a.x),std::cos(a.x)); }
+	friend Dual	cos(const Dual& a)
+	{ return chain(a,std::cos(a.x),-std::sin(a.x)); }
+	friend Dual	tanh(const Dual& a)
+	{ const numT t=std::tanh(a.x); return chain(a,t,numT(1.)-t*t); }
+	friend Dual	atan(const Dual& a)
+	{ return chain(a,std::atan(a.x),numT(1.)/(numT(1.)+a.x*a.x)); }
+	friend Dual	abs(const Dual& a) {return (a.x<0.)?-a:a;}
+	friend Dual	fabs(const Dual& a) {return abs(a);}
+	/** The value straight from std::pow: pow(x,p-1)*x is 0*inf at x=0
+		for p<1 */
+	friend Dual	pow(const Dual& a, const numT& p)
+	{
+	  const numT dp=(p == 0.0)?numT(0.):p*std::pow(a.x,p-numT(1.));
+	  return chain(a,std::pow(a.x,p),dp);
+	}
+
+  private:
+	numT	x;
+	numT	d[n];
+  };
+
+} // end namespace MODEL
+#endif
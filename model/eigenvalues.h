@@ -21,6 +21,7 @@
 #include "numerictypes.h"
 #include "numerictraits.h"
 #include "invariant.h"
+#include "smallmatrix.h"
 #include "utility.h"
 #include <stdexcept>
 
@@ -74,15 +75,21 @@ namespace MODEL
 	vect	wr;			// real part
 	vect	wi;			// imaginary part
 	
-	static const number radix=2.;
+	static const numT radix;
   };
 
+  template <integer dims, typename nelem, class NT >
+  const typename Eigenvalues<dims,nelem,NT>::numT Eigenvalues<dims,nelem,NT>::radix=2.;
+
   /** Calculate the eigenvalues. This is much too long: should be cut
 	  into itti bitty bite size pieces */
   template <integer dims, typename nelem, class NT >
   void
   Eigenvalues<dims,nelem,NT>::calculate(void)
   {
+	// 2x2 and 3x3 have a closed form
+	if (SmallMatrix<dims,NT>::eigenvalues(m,wr,wi)) return;
+
 	// Make sure we have balanced it and reduced to upper hessenberg
 	balance();
 	hessenberg();
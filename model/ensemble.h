@@ -0,0 +1,294 @@
+/***************************************************************************
+                          ensemble.h  -  many realisations in lockstep
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ENSEMBLE_H
+#define ENSEMBLE_H
+
+#include "probe.h"
+#include "bin.h"
+#include <vector>
+
+namespace MODEL {
+
+  /** An ODESystem for n independent realisations of the same
+	  stochastic problem, all integrated together. Dwell time and other
+	  statistics need a lot of events: instead of one very long run (or
+	  many processes) you take one short run of a large ensemble.
+
+	  The state is kept per component (structure of arrays): all n
+	  values of component 0, then all of component 1, ... The functions
+	  are called through VectorFunction::function_ensemble(), once per
+	  evaluation for the whole ensemble, so a model that overrides it
+	  gets loops the compiler can vectorise across realisations.
+
+	  Every realisation has its own noise; the numbers come from one
+	  generator, realisation after realisation, so realisation 0 of an
+	  ensemble of one sees the same noise as an ODESystem with the same
+	  seed. Only the Euler and Heun schemes are available.
+  */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class EnsembleODESystem : public TickTock
+  {
+  public:
+	typedef	typename NT::number					numT;
+	typedef	typename NT::vect					vect;
+	typedef typename NT::vf						vf;
+
+	/** n realisations, all starting from initial */
+	EnsembleODESystem(TimeFrame& T, vf& detpart, vf& stochpart, counter n,
+					  const vect& initial, Integration it=Euler, time res=1E-3)
+	  : TickTock(T,res), deter(&detpart), stoch(&stochpart), method(it),
+		size(n), u(n*dims), f(n*dims), g(n*dims), noise(n*dims)
+	{
+	  if (n<1)
+		throw std::logic_error("EnsembleODESystem::Need at least one realisation");
+	  if (method!=Euler && method!=Heun)
+		throw std::logic_error("EnsembleODESystem::Integration method not implemented");
+	  if (method==Heun)
+		{
+		  un.resize(n*dims); fn.resize(n*dims); gn.resize(n*dims);
+		}
+	  set_current(initial);
+	}
+
+	virtual void tick()
+	{
+	  step();
+	  if (method==Heun) heun(); else euler();
+	}
+
+	/** The number of realisations */
+	counter get_size(void) const {return size;}
+
+	/** Realisation r as a vect */
+	vect get_current(counter r) const
+	{
+	  vect x;
+	  for (integer i=0;i<dims;i++) x[i]=u[i*size+r];
+	  return x;
+	}
+
+	/** Component i of realisation r */
+	const numT& get_value(integer i, counter r) const {return u[i*size+r];}
+
+	/** The n values of component i, one after the other */
+	const numT* get_component(integer i) const {return &u[i*size];}
+
+	/** Put every realisation at x */
+	void set_current(const vect& x)
+	{
+	  for (integer i=0;i<dims;i++)
+		for (counter r=0;r<size;r++) u[i*size+r]=x[i];
+	}
+
+	/** Put realisation r at x */
+	void set_current(counter r, const vect& x)
+	{
+	  for (integer i=0;i<dims;i++) u[i*size+r]=x[i];
+	}
+
+	/** To give users a possibility to set the seed */
+	Normal& get_random()
+	{
+	  return rnd;
+	}
+
+	NO_COPY(EnsembleODESystem);
+
+  private:
+	/** dims normal numbers for every realisation */
+	void draw(void)
+	{
+	  for (counter r=0;r<size;r++)
+		for (integer i=0;i<dims;i++) noise[i*size+r]=rnd();
+	}
+
+	void euler(void)
+	{
+	  const numT h=dt;
+	  const numT sh=sqrt(dt);
+	  draw();
+	  deter->function_ensemble(&f[0],&u[0],size);
+	  stoch->function_ensemble(&g[0],&u[0],size);
+	  const counter m=size*dims;
+	  for (counter k=0;k<m;k++) u[k]+=h*f[k]+sh*g[k]*noise[k];
+	}
+
+	/** The same scheme as IHeun */
+	void heun(void)
+	{
+	  const numT h=dt;
+	  const numT sh=sqrt(dt);
+	  deter->function_ensemble(&f[0],&u[0],size);
+	  stoch->function_ensemble(&g[0],&u[0],size);
+	  draw();
+	  const counter m=size*dims;
+	  for (counter k=0;k<m;k++) un[k]=u[k]+h*f[k]+sh*g[k]*noise[k];
+	  deter->function_ensemble(&fn[0],&un[0],size);
+	  stoch->function_ensemble(&gn[0],&un[0],size);
+	  for (counter k=0;k<m;k++)
+		u[k]+=0.5*(h*(f[k]+fn[k])+sh*noise[k]*(g[k]+gn[k]));
+	}
+
+	vf*			deter;
+	vf*			stoch;
+	Integration	method;
+	counter		size;
+
+	/** State, function values and noise, n per component */
+	std::vector<numT>	u,f,g,noise;
+	/** The predicted point for Heun */
+	std::vector<numT>	un,fn,gn;
+
+	Normal rnd; // will be seeded with time()
+  };
+
+  //------------------------------------------------------------
+  /** Records the mean and the variance of every component over the
+	  ensemble: 2*dims numbers per tick, mean and variance of component
+	  0 first. */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class EnsembleProbe : public Probe
+  {
+  public:
+	typedef EnsembleODESystem<dims,nelem,NT> system;
+	typedef typename system::numT numT;
+
+	EnsembleProbe(TimeFrame& T, system& s, const string& n)
+	  : Probe(T,n), my_sys(&s){}
+	EnsembleProbe(TimeFrame& T, system& s, ostream& o)
+	  : Probe(T,o), my_sys(&s){}
+
+	virtual void probe(void)
+	{
+	  const counter n=my_sys->get_size();
+	  for (integer i=0;i<dims;i++)
+		{
+		  const numT* x=my_sys->get_component(i);
+		  numT sum=0.;
+		  for (counter r=0;r<n;r++) sum+=x[r];
+		  const numT mean=sum/n;
+		  numT var=0.;
+		  for (counter r=0;r<n;r++) var+=(x[r]-mean)*(x[r]-mean);
+		  add_data(mean);
+		  add_data((n>1)?var/(n-1):0.);
+		}
+	}
+
+  private:
+	system* my_sys;
+  };
+
+  //------------------------------------------------------------
+  /** BinDwellProbe for a whole ensemble: every realisation keeps its
+	  own state and time of the last switch, and all dwell times go
+	  into the same two Bins. */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class EnsembleDwellProbe : public GenericProbe
+  {
+  public:
+	typedef EnsembleODESystem<dims,nelem,NT> system;
+
+	EnsembleDwellProbe(TimeFrame& T, const string& n, Bin& b_up, Bin& b_down,
+					   system& sys, integer v, number threshold)
+	  : GenericProbe(T,n), my_sys(&sys), var(v), th(threshold),
+		avgn(0.), pdfwrite(false), my_b_up(&b_up), my_b_down(&b_down),
+		more_or_less(sys.get_size()), last_t(sys.get_size(),number(T))
+	{
+	  // Set inital state
+	  const counter size=my_sys->get_size();
+	  for (counter r=0;r<size;r++)
+		more_or_less[r]=(my_sys->get_value(var,r) > th);
+	}
+
+	/** call this with TRUE to make the output a pdf */
+	void write_pdf(bool pdf=true){pdfwrite=pdf;}
+
+	~EnsembleDwellProbe()
+	{
+	  write_data();
+	}
+
+	/** The number of switches in the whole ensemble */
+	const number& switches(void)
+	{
+	  return avgn;
+	}
+
+	virtual void print(ostream& out)
+	{
+	  write_bin(out,"# Dwell statistics for up state",*my_b_up);
+	  out << endl << endl;
+	  write_bin(out,"# Dwell statistics for down state",*my_b_down);
+	}
+
+	void probe(void)
+	{
+	  const counter size=my_sys->get_size();
+	  const number now=get_time();
+	  for (counter r=0;r<size;r++)
+		{
+		  bool now_more=(my_sys->get_value(var,r) > th);
+		  if (now_more != more_or_less[r])
+			{
+			  avgn++;
+			  if (more_or_less[r])
+				my_b_up->add_value(now-last_t[r]);
+			  else
+				my_b_down->add_value(now-last_t[r]);
+			  more_or_less[r]=now_more;
+			  last_t[r]=now;
+			}
+		}
+	}
+
+	NO_COPY(EnsembleDwellProbe);
+
+  private:
+	void write_bin(ostream& out, const char* title, Bin& b)
+	{
+	  out << title << endl;
+	  vector<number> bi=b.get_bins();
+	  if (!pdfwrite)
+		{
+		  vector<counter> hi=b.get_histo();
+		  for(counter i=0;i<bi.size();i++)
+			out << bi[i] << "\t" << hi[i] << endl;
+		}
+	  else
+		{
+		  vector<number> hi=b.get_pdf();
+		  for(counter i=0;i<bi.size();i++)
+			out << bi[i] << "\t" << hi[i] << endl;
+		}
+	}
+
+	system* my_sys;
+	integer var;
+	number th;
+	number avgn;
+	bool pdfwrite;
+
+	Bin* my_b_up;
+	Bin* my_b_down;
+
+	std::vector<bool>	more_or_less;
+	std::vector<number>	last_t;
+  };
+
+} // end namespace MODEL
+#endif
@@ -24,6 +24,7 @@
 // #include "odesystem.h"
 #include "random.h"
 #include "jacobian.h"
+#include "lusolve.h"
 
 namespace MODEL {
 
@@ -32,7 +33,9 @@ namespace MODEL {
   class ODESystem;
 
   /** Integration types */
-  enum Integration {Euler, RungeKutta, Milshtein,Heun};
+  enum Integration {Euler, RungeKutta, Milshtein,Heun,
+					MilshteinDiag, DormandPrince, Rosenbrock,
+					StochasticRK, HeunIto};
 
   /** Integrator: take a step dt from here to the next point */
   template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
@@ -102,6 +105,7 @@ namespace MODEL {
   {
   public:
     typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
     typedef typename base::vf vf;
     typedef typename base::vect vect;
 
@@ -142,6 +146,7 @@ namespace MODEL {
   {
   public:
     typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
     typedef typename base::vf vf;
     typedef typename base::vect vect;
   public:
@@ -157,7 +162,7 @@ namespace MODEL {
       // 4) at the end point, using the values of 3)
 
       vect k1,k2,k3,k4;
-      number dt2=dt/2.;
+      numT dt2=dt/2.;
 
       // Step 1)
 
@@ -193,22 +198,301 @@ namespace MODEL {
 
   };
 
+  //-------------------------------------------------------------------------
+  /** Dormand-Prince 5(4): Runge-Kutta with an embedded error estimate
+      and an adaptive step size. Deterministic only, like IRungeKutta.
+
+      A call to step() still covers exactly dt, so the ODESystem stays
+      on the TimeFrame grid: inside it takes as many substeps as the
+      tolerances need, and the last one is cut short to land on dt.
+      The substep size is remembered from call to call. So you can
+      give the ODESystem the resolution you want to see the result at,
+      and let the integrator find out how fine it has to go. */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class IDormandPrince : public Integrator<dims,nelem,NT>
+  {
+  public:
+    typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
+    typedef typename base::vf vf;
+    typedef typename base::vect vect;
+  public:
+    /** @param rtol relative and @param atol absolute tolerance per
+	substep */
+    IDormandPrince(vf& d, vf& s, numT rtol=1E-6, numT atol=1E-9)
+      : Integrator<dims,nelem,NT>(d,s), rt(rtol), at(atol), h(0.),
+	substeps(0), rejected(0) {}
+
+    /** Change the tolerances */
+    void set_tolerance(numT rtol, numT atol) {rt=rtol; at=atol;}
+
+    /** Number of accepted and rejected substeps so far */
+    counter get_substeps(void) const {return substeps;}
+    counter get_rejected(void) const {return rejected;}
+
+    virtual	vect& step(vect& current, time& dt)
+    {
+      vf& f(*Integrator<dims,nelem,NT>::deter);
+
+      // The tableau
+      const numT a21=numT(1)/5, a31=numT(3)/40, a32=numT(9)/40,
+	a41=numT(44)/45, a42=-numT(56)/15, a43=numT(32)/9;
+      const numT a51=numT(19372)/6561, a52=-numT(25360)/2187,
+	a53=numT(64448)/6561, a54=-numT(212)/729;
+      const numT a61=numT(9017)/3168, a62=-numT(355)/33,
+	a63=numT(46732)/5247, a64=numT(49)/176, a65=-numT(5103)/18656;
+      const numT b1=numT(35)/384, b3=numT(500)/1113, b4=numT(125)/192,
+	b5=-numT(2187)/6784, b6=numT(11)/84;
+      const numT e1=numT(71)/57600, e3=-numT(71)/16695,
+	e4=numT(71)/1920, e5=-numT(17253)/339200, e6=numT(22)/525,
+	e7=-numT(1)/40;
+
+      if (h<=0.0 || h>dt) h=dt;
+      numT left=dt;
+
+      // parameters may have changed since the last call: no FSAL across calls
+      vect k1(f(current)),k2,k3,k4,k5,k6,k7;
+      vect pos,next;
+
+      while (left>0.0)
+	{
+	  // a few ulps short still lands on dt, instead of leaving a
+	  // remainder no step can take
+	  const bool last=(h>=left*(numT(1.)-numT(4.)*Precision<numT>::eps()));
+	  const numT hh=last?left:h;
+	  if (hh<=Precision<numT>::eps()*dt)
+	    throw std::logic_error("IDormandPrince::Step size too small");
+
+	  pos=current; pos+=(hh*a21)*k1;
+	  k2=f(pos);
+	  pos=current; pos+=hh*(a31*k1+a32*k2);
+	  k3=f(pos);
+	  pos=current; pos+=hh*(a41*k1+a42*k2+a43*k3);
+	  k4=f(pos);
+	  pos=current; pos+=hh*(a51*k1+a52*k2+a53*k3+a54*k4);
+	  k5=f(pos);
+	  pos=current; pos+=hh*(a61*k1+a62*k2+a63*k3+a64*k4+a65*k5);
+	  k6=f(pos);
+	  next=current; next+=hh*(b1*k1+b3*k3+b4*k4+b5*k5+b6*k6);
+	  k7=f(next);
+
+	  // scaled RMS of the difference between 5th and 4th order
+	  numT err(0.);
+	  for(integer i=0;i<dims;i++)
+	    {
+	      const numT e=hh*(e1*k1[i]+e3*k3[i]+e4*k4[i]+e5*k5[i]+e6*k6[i]+e7*k7[i]);
+	      const numT sc=at+rt*max(abs(current[i]),abs(next[i]));
+	      err+=(e/sc)*(e/sc);
+	    }
+	  err=sqrt(err/dims);
+
+	  // the usual controller, with a safety factor
+	  numT fac=(err==0.0)?numT(5.):numT(0.9)*pow(err,numT(-0.2));
+	  if (fac>5.) fac=5.;
+	  if (fac<0.2) fac=0.2;
+
+	  if (err<=1.)
+	    {
+	      current=next;
+	      k1=k7;		// first same as last
+	      left=last?numT(0.):left-hh;
+	      ++substeps;
+	      // do not let the cut short last step shrink h
+	      if (!last || hh*fac>h) h=hh*fac;
+	    }
+	  else
+	    {
+	      h=hh*fac;	// err>1, so fac<0.9
+	      ++rejected;
+	    }
+	}
+      return current;
+    }
+
+  private:
+    /** tolerances */
+    numT rt,at;
+    /** substep to try next */
+    numT h;
+    /** statistics */
+    counter substeps,rejected;
+  };
+
+  //-------------------------------------------------------------------------
+  /** A linearly implicit integrator for stiff problems: the
+      Rosenbrock 2(3) triple of Shampine and Reichelt (the one behind
+      Matlab's ode23s), with d=1/(2+sqrt(2)). Every substep solves
+      three linear systems with W=I-d.h.J instead of iterating to
+      convergence. It is a W method, second order even when J is out
+      of date, so the jacobian is kept until a substep gets rejected
+      and W is only factorised again when h changes by more than 20%.
+      Usually the work per substep is two evaluations and three back
+      substitutions.
+
+      Like IDormandPrince, step() covers exactly dt with adaptive
+      substeps. Deterministic only. */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class IRosenbrock : public Integrator<dims,nelem,NT>
+  {
+  public:
+    typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
+    typedef typename base::vf vf;
+    typedef typename base::vect vect;
+    typedef typename base::matrix matrix;
+  public:
+    /** @param rtol relative and @param atol absolute tolerance per
+	substep */
+    IRosenbrock(vf& d, vf& s, numT rtol=1E-5, numT atol=1E-12)
+      : Integrator<dims,nelem,NT>(d,s), J(d), lu(NULL), rt(rtol), at(atol),
+	h(0.), hw(0.), fresh(false), substeps(0), rejected(0), jacobians(0) {}
+
+    ~IRosenbrock() {delete lu;}
+
+    /** Change the tolerances */
+    void set_tolerance(numT rtol, numT atol) {rt=rtol; at=atol;}
+
+    /** Number of accepted and rejected substeps and of jacobians so far */
+    counter get_substeps(void) const {return substeps;}
+    counter get_rejected(void) const {return rejected;}
+    counter get_jacobians(void) const {return jacobians;}
+
+    virtual	vect& step(vect& current, time& dt)
+    {
+      vf& f(*Integrator<dims,nelem,NT>::deter);
+      const numT d=numT(1.)/(numT(2.)+sqrt(numT(2.)));
+      const numT e32=numT(6.)+sqrt(numT(2.));
+
+      if (h<=0.0 || h>dt) h=dt;
+      if (lu==NULL) update_jacobian(current);
+      numT left=dt;
+
+      vect f0(f(current)),f1,f2,k1,k2,k3,pos;
+
+      while (left>0.0)
+	{
+	  // a few ulps short still lands on dt, instead of leaving a
+	  // remainder no step can take
+	  const bool last=(h>=left*(numT(1.)-numT(4.)*Precision<numT>::eps()));
+	  const numT hh=last?left:h;
+	  if (hh<=Precision<numT>::eps()*dt)
+	    throw std::logic_error("IRosenbrock::Step size too small");
+	  // W with a slightly different h is still a W method: keep it
+	  if (abs(hh*d-hw)>numT(0.2)*hw) factorise(hh*d);
+
+	  // W.k1 = f0
+	  k1=f0;
+	  lu->solve(k1);
+	  // W.(k2-k1) = f(y+h/2.k1) - k1
+	  pos=current; pos+=(0.5*hh)*k1;
+	  f1=f(pos);
+	  k2=f1-k1;
+	  lu->solve(k2);
+	  k2+=k1;
+	  // second order solution
+	  pos=current; pos+=hh*k2;
+	  f2=f(pos);
+	  // W.k3 = f2 - e32.(k2-f1) - 2.(k1-f0), for the error only
+	  k3=f2-e32*(k2-f1)-2.*(k1-f0);
+	  lu->solve(k3);
+
+	  numT err(0.);
+	  for(integer i=0;i<dims;i++)
+	    {
+	      const numT e=hh/6.*(k1[i]-2.*k2[i]+k3[i]);
+	      const numT sc=at+rt*max(abs(current[i]),abs(pos[i]));
+	      err+=(e/sc)*(e/sc);
+	    }
+	  err=sqrt(err/dims);
+
+	  numT fac=(err==0.0)?numT(5.):numT(0.8)*pow(err,numT(-1.)/3.);
+	  if (fac>5.) fac=5.;
+	  if (fac<0.2) fac=0.2;
+
+	  if (err<=1.)
+	    {
+	      current=pos;
+	      f0=f2;		// first same as last
+	      left=last?numT(0.):left-hh;
+	      ++substeps;
+	      fresh=false;
+	      // only change h (and factorise again) if it is worth it
+	      if (fac>1.5 && (!last || hh*fac>h)) h=hh*fac;
+	    }
+	  else
+	    {
+	      ++rejected;
+	      // a rejection may mean J is out of date: get a new one first
+	      if (!fresh) update_jacobian(current);
+	      h=hh*fac;	// err>1, so fac<0.8
+	    }
+	}
+      return current;
+    }
+
+  private:
+    /** New jacobian at u, forces a new factorisation */
+    void update_jacobian(const vect& u)
+    {
+      jac=J.calculate(u);
+      ++jacobians;
+      fresh=true;
+      hw=0.;
+    }
+
+    /** W = I - dh.J, decomposed */
+    void factorise(const numT& dh)
+    {
+      for(integer i=0;i<dims;i++)
+	for(integer j=0;j<dims;j++)
+	  W[i][j]=((i==j)?numT(1.):numT(0.))-dh*jac[i][j];
+      if (lu==NULL) lu=new LUSolve<dims,NT>(W);
+      else lu->update();
+      hw=dh;
+    }
+
+  private:
+    /** jacobian of the deterministic part */
+    Jacobian<dims,NT> J;
+    matrix jac;
+    /** W and its decomposition */
+    matrix W;
+    LUSolve<dims,NT>* lu;
+    /** tolerances */
+    numT rt,at;
+    /** substep to try next, and d.h for the current W */
+    numT h,hw;
+    /** has jac been calculated at the start of this substep? */
+    bool fresh;
+    /** statistics */
+    counter substeps,rejected,jacobians;
+
+    NO_COPY(IRosenbrock);
+  };
+
   //----------------------------------------------------------------------
   /** An integrator that can actually do stochastics - the counterpart
       of Euler
+
+      If every g[i] depends on u[i] only (diagonal noise, as in most
+      rate equations), set diagonal: the correction then only needs
+      the derivative of g along g itself, which costs one extra
+      evaluation of the stochastic part instead of a full jacobian.
+      (MilshteinDiag in ODESystem)
       @see Random */
   template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
   class IMilshtein : public Integrator<dims,nelem,NT>
   {
   public:
     typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
     typedef typename base::vf vf;
     typedef typename base::vect vect;
     typedef typename base::matrix matrix;
 
   public:
-    IMilshtein(vf& d, vf& s)
-      : Integrator<dims,nelem,NT>(d,s){}
+    IMilshtein(vf& d, vf& s, bool diagonal=false)
+      : Integrator<dims,nelem,NT>(d,s), J(s), diag(diagonal){}
 
     virtual	vect& step(vect& current, time& dt)
     {
@@ -227,7 +511,7 @@ namespace MODEL {
       for(counter i=0;i<dims;i++) noise[i]=rnd();
 
       // Additive component (Euler)
-      number sqdt=sqrt(dt);
+      numT sqdt=sqrt(dt);
       vect g=(*Integrator<dims,nelem,NT>::stoch)(oldcurrent);
 
       // Multiply each component with its noise
@@ -238,17 +522,26 @@ namespace MODEL {
       current+=sqdt*ng;
 
       // Extra Millstein
-      Jacobian<dims,NT> J(*Integrator<dims,nelem,NT>::stoch);
-      matrix dgdy=J.calculate(oldcurrent,g);
-
       vect dgs(0.);
-      for(counter i=0;i<dims;i++)
-	for (counter j=0;j<dims;j++)
-	  {
-	    number gg=0.5*dgdy[i][j]*g[j];
-	    dgs[i]-=gg; // Ito rules !
-	    if(i==j)dgs[i]+=gg*(noise[i]*noise[j]);
-	  }
+      if (diag)
+	{
+	  // dgdy is diagonal, so dgdy.g has all we need
+	  vect dg=J.directional(oldcurrent,g,g);
+	  for(counter i=0;i<dims;i++)
+	    dgs[i]=0.5*dg[i]*(noise[i]*noise[i]-1.); // Ito rules !
+	}
+      else
+	{
+	  matrix dgdy=J.calculate(oldcurrent,g);
+
+	  for(counter i=0;i<dims;i++)
+	    for (counter j=0;j<dims;j++)
+	      {
+		numT gg=0.5*dgdy[i][j]*g[j];
+		dgs[i]-=gg; // Ito rules !
+		if(i==j)dgs[i]+=gg*(noise[i]*noise[j]);
+	      }
+	}
 
       current+=dt*dgs;
       return current;
@@ -264,6 +557,12 @@ namespace MODEL {
   private:
     /** Normal random */
     Normal rnd; // will be seeded with time()
+
+    /** Jacobian of the stochastic part, kept from step to step */
+    Jacobian<dims,NT> J;
+
+    /** Is the noise diagonal? */
+    bool diag;
   };
 
   /** The IHeun integrator is a STRATONOVICH INTEGRATOR. However, you
@@ -276,6 +575,7 @@ namespace MODEL {
   {
   public:
     typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
     typedef typename base::vf vf;
     typedef typename base::vect vect;
     typedef typename base::matrix matrix;
@@ -303,8 +603,8 @@ namespace MODEL {
       vect oldcurrent(current);
 
       // Some to be optimized out temps
-      const number h=dt;
-      const number sh=sqrt(dt);
+      const numT h=dt;
+      const numT sh=sqrt(dt);
 
       vect q = (*Integrator<dims,nelem,NT>::deter)(oldcurrent);
       vect g = (*Integrator<dims,nelem,NT>::stoch)(oldcurrent);
@@ -364,8 +664,9 @@ namespace MODEL {
   };
 
   /** The Heun integrator with the Ito correction (numerically, first
-      order) added
-      \todo: This is not yet finished
+      order) added: the drift is corrected with -1/2.g[i].dg[i]/du[i]
+      at both points, so the Stratonovich scheme converges to the Ito
+      solution. Each component has its own noise, as in IHeun.
   */
 
   template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
@@ -373,17 +674,14 @@ namespace MODEL {
   {
   public:
     typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
     typedef typename base::vf vf;
     typedef typename base::vect vect;
     typedef typename base::matrix matrix;
   public:
 
     IHeunIto(vf& d, vf& s)
-      : Integrator<dims,nelem,NT>(d,s)
-    {
-      // Create the Jacobian for the stochastic part
-      jacostoch = new Jacobian<dims,NT>(s);
-    }
+      : Integrator<dims,nelem,NT>(d,s), jacostoch(s) {}
 
     virtual	vect& step(vect& current, time& dt)
     {
@@ -406,8 +704,8 @@ namespace MODEL {
       vect oldcurrent(current);
 
       // Some to be optimized out temps
-      const number h=dt;
-      const number sh=sqrt(dt);
+      const numT h=dt;
+      const numT sh=sqrt(dt);
 
       vect q = (*Integrator<dims,nelem,NT>::deter)(oldcurrent);
       vect g = (*Integrator<dims,nelem,NT>::stoch)(oldcurrent);
@@ -416,11 +714,11 @@ namespace MODEL {
       // the Ito correction (we also do this the second time)
       // We can use the code from the Millshtein algo to do this.
 
-      matrix db;
-      db=jacostoch->calculate(oldcurrent,g);
+      // only dg[i]/dx[i] is needed, not the whole jacobian
+      vect db=jacostoch.diagonal(oldcurrent,g);
 
       // apply the correction
-      // q-= ... ADD CODE HERE.
+      for(counter i=0;i<dims;i++) q[i]-=0.5*db[i]*g[i];
 
 
       // Generate numbers: noise is _NOT_ correlated between modes.
@@ -453,6 +751,10 @@ namespace MODEL {
       vect qn=(*Integrator<dims,nelem,NT>::deter)(oldcurrent);
       vect gn=(*Integrator<dims,nelem,NT>::stoch)(oldcurrent);
 
+      // and the same correction at the predicted point
+      db=jacostoch.diagonal(oldcurrent,gn);
+      for(counter i=0;i<dims;i++) qn[i]-=0.5*db[i]*gn[i];
+
       for(counter i=0;i<dims;i++)
 	{
 	  current[i]+=0.5*( h*( q[i] + qn[i]) + sh*u[i]*(g[i]+gn[i]));
@@ -466,12 +768,108 @@ namespace MODEL {
       return current;
     }
 
+    /** To give users a possibility to set the seed */
+    Normal& get_random()
+    {
+      return rnd;
+    }
+
   private:
     /** Normal random */
     Normal rnd; // will be seeded with time()
 
     /** The jacobian */
-    Jacobian<dims,NT>* jacostoch;
+    Jacobian<dims,NT> jacostoch;
+
+    NO_COPY(IHeunIto);
+  };
+
+  //----------------------------------------------------------------------
+  /** Stochastic Runge-Kutta of strong order 1.5 for Ito equations
+      with diagonal noise: SRIW1 from A. Roessler, SIAM J. Numer. Anal.
+      48 (2010) 922. Derivative free, and per step it needs two
+      evaluations of the deterministic part and four of the stochastic
+      part (IHeun needs two of each, but is only strong order 1).
+
+      Every component has its own Wiener process, as in the other
+      integrators. Besides the increment dW the scheme needs the
+      iterated integrals I10, I11 and I111, which are built from dW
+      and a second independent normal dZ. */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class IStochasticRK : public Integrator<dims,nelem,NT>
+  {
+  public:
+    typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
+    typedef typename base::vf vf;
+    typedef typename base::vect vect;
+  public:
+    IStochasticRK(vf& d, vf& s)
+      : Integrator<dims,nelem,NT>(d,s) {}
+
+    virtual	vect& step(vect& current, time& dt)
+    {
+      vf& f(*Integrator<dims,nelem,NT>::deter);
+      vf& g(*Integrator<dims,nelem,NT>::stoch);
+
+      const numT h=dt;
+      const numT sh=sqrt(dt);
+
+      // The random part: dW, and the iterated integrals
+      // I10=h/2.(dW+dZ/sqrt(3)), I11=(dW^2-h)/2, I111=(dW^3-3h.dW)/6
+      vect dW,I10,I11,I111;
+      for(counter i=0;i<dims;i++) dW[i]=sh*rnd();
+      for(counter i=0;i<dims;i++)
+	{
+	  const numT dZ=sh*rnd();
+	  I10[i]=0.5*h*(dW[i]+dZ/sqrt(numT(3.)));
+	  I11[i]=0.5*(dW[i]*dW[i]-h);
+	  I111[i]=(dW[i]*dW[i]*dW[i]-3.*h*dW[i])/6.;
+	}
+
+      // stages: H0 for the drift, H1 for the diffusion. H0_3 and
+      // H0_4 are the current point, so f is needed there only once.
+      vect f1(f(current));
+      vect g1(g(current));
+
+      vect H(current);
+      for(counter i=0;i<dims;i++) H[i]+=0.75*h*f1[i]+1.5*g1[i]*I10[i]/h;
+      vect f2(f(H));
+
+      H=current;
+      for(counter i=0;i<dims;i++) H[i]+=0.25*h*f1[i]+0.5*sh*g1[i];
+      vect g2(g(H));
+
+      H=current;
+      for(counter i=0;i<dims;i++) H[i]+=h*f1[i]-sh*g1[i];
+      vect g3(g(H));
+
+      H=current;
+      for(counter i=0;i<dims;i++)
+	H[i]+=0.25*h*f1[i]+sh*(-5.*g1[i]+3.*g2[i]+0.5*g3[i]);
+      vect g4(g(H));
+
+      for(counter i=0;i<dims;i++)
+	{
+	  const numT a=I11[i]/sh, b=I10[i]/h, c=I111[i]/h;
+	  current[i]+=h*(f1[i]+2.*f2[i])/3.
+	    +g1[i]*(-dW[i]-a+2.*b-2.*c)
+	    +g2[i]*((4.*dW[i]+4.*a-4.*b+5.*c)/3.)
+	    +g3[i]*((2.*dW[i]-a-2.*b-2.*c)/3.)
+	    +g4[i]*c;
+	}
+      return current;
+    }
+
+    /** To give users a possibility to set the seed */
+    Normal& get_random()
+    {
+      return rnd;
+    }
+
+  private:
+    /** Normal random */
+    Normal rnd; // will be seeded with time()
   };
 
 
@@ -482,6 +880,7 @@ namespace MODEL {
   {
   public:
     typedef Integrator<dims,nelem,NT> base;
+    typedef typename base::numT numT;
     typedef typename base::vf vf;
     typedef typename base::vect vect;
     typedef typename base::matrix matrix;
@@ -509,8 +908,8 @@ namespace MODEL {
       vect oldcurrent(current);
 
       // Some to be optimized out temps
-      const number h=dt;
-      const number sh=sqrt(dt);
+      const numT h=dt;
+      const numT sh=sqrt(dt);
 
       vect q = (*Integrator<dims,nelem,NT>::deter)(oldcurrent);
       vect g = (*Integrator<dims,nelem,NT>::stoch)(oldcurrent);
@@ -20,7 +20,7 @@
 #define INVARIANT_H
 
 #include "lusolve.h"
-#include "invariant.h"
+#include "smallmatrix.h"
 
 namespace MODEL{
   /**Calculates the invariants of a matrix (sum over diagonal minors)
@@ -62,10 +62,11 @@ namespace MODEL{
 	//cout << "M:" << m << endl;
 	
     // Previously: typedef NumVector<dims-1,NumericTraits< NumVector<dims-1, NumericTraits<numT, dims-1> >,dims-1 > > 	smallermatrix;
-	typedef NumVector<dims-1,numT,NT>	smallervector;
-	typedef NumVector<dims-1,smallervector,NT>	smallermatrix;
 	typedef Invariant<dims-1, NumericTraits< numT,dims-1> > 	smallerinv;
+	typedef typename smallerinv::matrix	smallermatrix;
 	
+	if (SmallMatrix<dims,NT>::closed && (done==0 || i==(dims-1)))
+	  return SmallMatrix<dims,NT>::invariant(m,i);
 	if (i==(dims-1)) {LUSolve<dims,NT> l(m,true); return l.det();}
 	else
 	  {
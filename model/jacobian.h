@@ -24,7 +24,10 @@
 
 namespace MODEL {
 
-  /**	Calculates the Jacobian of a VF using finite differences.
+  /**	Calculates the Jacobian of a VF using finite differences,
+		unless the VF supplies it itself (VectorFunction::jacobian).
+		The shifted points all go to VectorFunction::function_batch()
+		in a single call.
 		i is always the component of the function in question,
 		j is always the parameter we differentiate to.
   */
@@ -45,7 +48,7 @@ namespace MODEL {
 	  epsilon(JEps) {}	
 	~Jacobian() {if (owned) delete f;}
 	/** copying is allowed */
-	Jacobian(const Jacobian& cj) : owned(false), f(cj.f) {}
+	Jacobian(const Jacobian& cj) : owned(false), f(cj.f), epsilon(cj.epsilon) {}
 	
 	/** Calculate one element of the Jacobian J(i,j) = df(i)/dj. Not implemented. */
 	numT	calculate_didj(integer i, integer j, const vect& u);
@@ -65,12 +68,29 @@ namespace MODEL {
 	/** Calculate full Jacobian using 2 evaluations. 
 		j[i][j]=df[i]dx[j] */
 	matrix	calculate(const vect& u)
-	{ vect fu( (*f)(u) ); return calculate(u,fu);}
+	{
+	  matrix	jac(0.);
+	  if (f->jacobian(jac,u)) return jac;
+	  vect fu( (*f)(u) ); return calculate(u,fu);
+	}
 
 	/** Calculate full Jacobian using 3 evaluations. 
 		j[i][j]=df[i]dx[j] */
 	matrix	calculate_accurate(const vect& u)
-	{ vect fu( (*f)(u) ); return calculate_accurate(u,fu);}
+	{
+	  matrix	jac(0.);
+	  if (f->jacobian(jac,u)) return jac;
+	  vect fu( (*f)(u) ); return calculate_accurate(u,fu);
+	}
+
+	/** The derivative of f at u in the direction v, J.v, for the
+		price of one evaluation (fu=f(u) is given) instead of dims. Uses
+		the jacobian of the function if it has one. */
+	vect	directional(const vect& u, const vect& fu, const vect& v);
+
+	/** Only the diagonal, df[i]/dx[i], from the same differences as
+		calculate() (fu=f(u) is given), without filling in the rest */
+	vect	diagonal(const vect& u, const vect& fu);
 
 	/** What function are we working on? */
 	vf& get_function(void)
@@ -86,7 +106,7 @@ namespace MODEL {
 	bool	owned;
 	vf*	f;	
 	/** epsilon is the relative step size used in the finite difference jacobian. */
-	number					epsilon;
+	numT					epsilon;
   };
 
   // This returns:
@@ -104,25 +124,29 @@ namespace MODEL {
   {	
 	// There might be a faster way to do this, but I haven found it yet
 	matrix	jac(0.);
-	
+	if (f->jacobian(jac,u)) return jac;
+
+	// all the shifted points first, so they can be evaluated in one go
+	vect	udu[dims],fudu[dims];
+	numT	du[dims];
 	for(integer j=0;j<dims;j++)
 	  {
-		vect	udu(u);
+		udu[j]=u;
 						
-		numT	du = epsilon*abs(u[j]);		
-		
-		if(du==0.0) du = epsilon;		// avoid numerical error	
-		udu[j] += du;			// "
-		du = udu[j] - u[j];		// "
+		du[j] = epsilon*abs(u[j]);		
 		
+		if(du[j]==0.0) du[j] = epsilon;		// avoid numerical error	
+		udu[j][j] += du[j];			// "
+		du[j] = udu[j][j] - u[j];		// "
+	  }
 
-		vect	fudu( (*f)(udu) );
+	f->function_batch(fudu,udu,dims);
 		
-		for(integer i=0;i<dims;i++)
-		  {
-			jac[i][j]=(fudu[i]-fu[i])/du;	
-		  }		
-	  }
+	for(integer j=0;j<dims;j++)
+	  for(integer i=0;i<dims;i++)
+		{
+		  jac[i][j]=(fudu[j][i]-fu[i])/du[j];	
+		}		
 	return jac;
   }
 
@@ -132,10 +156,16 @@ namespace MODEL {
   {	
 	// There might be a faster way to do this, but I haven found it yet
 	matrix	jac(0.);
+	if (f->jacobian(jac,u)) return jac;
 	
+	// points u+du for every j, then u-du: one batch of 2.dims
+	vect	udu[2*dims],fudu[2*dims];
+	numT	dud[dims];
 	for(integer j=0;j<dims;j++)
 	  {
-		vect	updu(u),umdu(u);
+		vect&	updu(udu[j]);
+		vect&	umdu(udu[dims+j]);
+		updu=u; umdu=u;
 						
 		numT	du = epsilon*abs(u[j])/2.,dup,dum;		
 		
@@ -147,17 +177,80 @@ namespace MODEL {
 		umdu[j] -= du;			// "
 		dum = u[j] - umdu[j];		// "
 
-		vect	fupdu( (*f)(updu) );
-		vect	fumdu( (*f)(umdu) );
+		dud[j] = dum+dup;
+	  }
+
+	f->function_batch(fudu,udu,2*dims);
 		
+	for(integer j=0;j<dims;j++)
+	  for(integer i=0;i<dims;i++)
+		{
+		  jac[i][j]=(fudu[j][i]-fudu[dims+j][i])/dud[j];	
+		}		
+	return jac;
+  }
+
+  template <integer dims, class NT>
+  typename NT::vect
+  Jacobian<dims,NT>::directional(const vect& u, const vect& fu, const vect& v)
+  {
+	vect	res(0.);
+	matrix	jac(0.);
+	if (f->jacobian(jac,u))
+	  {
 		for(integer i=0;i<dims;i++)
-		  {
-			jac[i][j]=(fupdu[i]-fumdu[i])/(dum+dup);	
-		  }		
+		  for(integer j=0;j<dims;j++) res[i]+=jac[i][j]*v[j];
+		return res;
 	  }
-	return jac;
+
+	// same relative step as calculate(), along v instead of an axis:
+	// no component moves more than epsilon*abs(u[j])
+	numT	h(0.);
+	for(integer j=0;j<dims;j++)
+	  if (v[j]!=0.0)
+		{
+		  numT	hj = epsilon*abs(u[j]/v[j]);
+		  if (hj==0.0) hj = epsilon/abs(v[j]);		// avoid numerical error
+		  if (h==0.0 || hj<h) h=hj;
+		}
+	if (h==0.0) return res;
+
+	vect	udu(u);
+	for(integer j=0;j<dims;j++) udu[j]+=h*v[j];
+	vect	fudu( (*f)(udu) );
+
+	for(integer i=0;i<dims;i++) res[i]=(fudu[i]-fu[i])/h;
+	return res;
   }
 
+  template <integer dims, class NT>
+  typename NT::vect
+  Jacobian<dims,NT>::diagonal(const vect& u, const vect& fu)
+  {
+	vect	res(0.);
+	matrix	jac(0.);
+	if (f->jacobian(jac,u))
+	  {
+		for(integer i=0;i<dims;i++) res[i]=jac[i][i];
+		return res;
+	  }
+
+	vect	udu[dims],fudu[dims];
+	numT	du[dims];
+	for(integer j=0;j<dims;j++)
+	  {
+		udu[j]=u;
+		du[j] = epsilon*abs(u[j]);
+		if(du[j]==0.0) du[j] = epsilon;		// avoid numerical error
+		udu[j][j] += du[j];
+		du[j] = udu[j][j] - u[j];
+	  }
+
+	f->function_batch(fudu,udu,dims);
+
+	for(integer i=0;i<dims;i++) res[i]=(fudu[i][i]-fu[i])/du[i];
+	return res;
+  }
 
 } // end namespace
 #endif
@@ -77,11 +77,18 @@ namespace MODEL{
 	
   public:
 	/** Fraction of step to take at least */
-	static const number	alfa=1e-4;	
+	static const numT	alfa;
 	/** Tolerance to see if the new point is too close. Usually signals convergence */
-	static const number	tolerance=1e-7;
+	static const numT	tolerance;
   };
 
+  template <integer dims, class NT>
+  const typename LineSearch<dims,NT>::numT LineSearch<dims,NT>::alfa=1e-4;
+
+  template <integer dims, class NT>
+  const typename LineSearch<dims,NT>::numT
+  LineSearch<dims,NT>::tolerance=Precision<numT>::tolerance(1e-7);
+
   template <integer dims, class NT>
   void LineSearch<dims,NT>::operator()			
 	(	const vect& uold, const numT fold,
@@ -91,24 +98,24 @@ namespace MODEL{
 	tooclose=false;				// in NRC called: check
 	
 	// rescale if too large
-	number	pl(length(p)); // in NRC called: sum
+	numT	pl(length(p)); // in NRC called: sum
 	if(pl>maxstep) p*=maxstep/pl; 	
 
 	// scalar poduct of the gradient and the direction	
-	number	slope(grad*p);		
+	numT	slope(grad*p);		
 	
 	// calculate minimal lambda using heuristic
-	number 	lambdascale(0.0);	// in NRC called: test
+	numT 	lambdascale(0.0);	// in NRC called: test
 	for (integer i=0;i<dims;i++)
 	  {
-		number temp;
-		temp=abs(p[i])/max(abs(uold[i]),number(1.0));
+		numT temp;
+		temp=abs(p[i])/max(abs(uold[i]),numT(1.0));
 		if (temp > lambdascale) lambdascale=temp;
 	  }
 	
-	number	lambdamin(tolerance/lambdascale),lambda(1.);		// in NRC called alamin,alam
+	numT	lambdamin(tolerance/lambdascale),lambda(1.);		// in NRC called alamin,alam
 	
-	number lambda2(0.),templambda(0.),f2(0.);
+	numT lambda2(0.),templambda(0.),f2(0.);
 	while (true) // Search forever
 	  {
 			
@@ -127,17 +134,17 @@ namespace MODEL{
 			// All other steps: use a cubic (a few more calculations)
 			else
 			  {	
-				number	rhs1 = f-fold-lambda*slope;
-				number	rhs2 = f2-fold-lambda2*slope;
+				numT	rhs1 = f-fold-lambda*slope;
+				numT	rhs2 = f2-fold-lambda2*slope;
    					
-				number	a=(rhs1/(lambda*lambda)-rhs2/(lambda2*lambda2))/(lambda-lambda2);
-				number	b=(-lambda2*rhs1/(lambda*lambda)
+				numT	a=(rhs1/(lambda*lambda)-rhs2/(lambda2*lambda2))/(lambda-lambda2);
+				numT	b=(-lambda2*rhs1/(lambda*lambda)
 						   +lambda*rhs2/(lambda2*lambda2))/(lambda-lambda2);
    					
 				if (a == 0.0) templambda = -slope/(2.0*b); // easy roots
 				else
 				  {	// use discriminant
-					number	disc=b*b-3.0*a*slope;
+					numT	disc=b*b-3.0*a*slope;
 					if (disc<0.0) templambda=0.5*lambda;
 					else if (b <= 0.0) templambda=(-b+sqrt(disc))/(3.0*a);
 					else templambda=-slope/(b+sqrt(disc));  												
@@ -147,7 +154,7 @@ namespace MODEL{
 		  }
 		lambda2=lambda;
 		f2 = f;
-		lambda=max(templambda,0.1*lambda);	// don't overdo it.
+		lambda=max(templambda,numT(0.1)*lambda);	// don't overdo it.
 	  }
   }
 
@@ -20,8 +20,11 @@
 
 #include "utility.h"
 #include <stdexcept>
+#include <vector>
 #include "numerictraits.h"
 #include "numerictypes.h"
+#include "rowkernels.h"
+#include "smallmatrix.h"
 
 namespace MODEL {
 
@@ -42,8 +45,21 @@ namespace MODEL {
 
 	/** Solve it, but with efficient return of vector */
 	void	solve(vect& u);
+
+	/** Solve for n right-hand sides at once, in place. This makes
+		one pass over the factors for all of them, instead of one per
+		vector; the results are the same as calling solve() n times. */
+	void	solve_many(vect* u, counter n);
+
+	/** Same, for a block of right-hand sides: every row of U is one
+		of them (so this is not M^-1 U, but its transpose) */
+	void	solve_many(matrix& U) {solve_many(&U[0],dims);}
 	/** Determinant */
 	numT	det(void);
+
+	/** Decompose again, after the matrix has been changed (it is
+		decomposed in place, so you have to fill it in again) */
+	void	update(void) {decompose();}
  		
   private:
 	// to avoid silly errors
@@ -51,22 +67,35 @@ namespace MODEL {
 		
 	// perform decomposition
 	void	decompose(void);
+	// the two ways of doing it, with identical results
+	void	decompose_crout(vect& rowscale);
+	void	decompose_rows(vect& rowscale);
 
   private:
 	matrix*					M;		
 	integer					pivotrows[dims];
 	numT					pivotsign;
+
+	// for 2x2 and 3x3, M holds the inverse instead of the factors
+	bool					inverted;
+	numT					determinant;
 			
 	bool	owned;
 
-	static const numT	tiny=1.E-20;
+	static const numT	tiny;
   };
 
+  template <integer dims, class NT >
+  const typename LUSolve<dims,NT>::numT LUSolve<dims,NT>::tiny=1.E-20;
+
   template <integer dims, class NT >
   void LUSolve<dims,NT>::decompose(void)
   {
     matrix&		a(*M);
 
+	inverted=SmallMatrix<dims,NT>::invert(a,determinant);
+	if (inverted) return;
+
 	pivotsign=1.0;	
 	vect	rowscale(1.);
 	// Test for singularity
@@ -80,6 +109,18 @@ namespace MODEL {
 		rowscale[i]/=big;
 	  }
 	
+	if (RowKernel<numT>::simd) decompose_rows(rowscale);
+	else decompose_crout(rowscale);
+  }
+
+  /** Crout's method, straight from NRC. The inner loops are dot
+	  products down a column, which keeps the sum in a register: the
+	  best choice without SIMD (and for long double). */
+  template <integer dims, class NT >
+  void LUSolve<dims,NT>::decompose_crout(vect& rowscale)
+  {
+    matrix&		a(*M);
+
 	numT sum(0.);
 	for (integer j=0;j<dims;j++)
 	  {
@@ -120,9 +161,56 @@ namespace MODEL {
 	  }
   }
 
+  /** Right-looking elimination: once column j is known, the pivot
+	  row is subtracted from every row below it, so the inner loop
+	  runs along a contiguous row (see rowkernels.h). Every element
+	  sees the same subtractions in the same order as in Crout's
+	  method, so pivots and results are identical. */
+  template <integer dims, class NT >
+  void LUSolve<dims,NT>::decompose_rows(vect& rowscale)
+  {
+    matrix&		a(*M);
+
+	for (integer j=0;j<dims;j++)
+	  {
+		numT 	big(0.);
+		integer imax(-1);
+		numT    dum(0.);
+		for (integer i=j;i<dims;i++)
+		  {
+			if ( (dum=rowscale[i]*abs(a[i][j]) ) >= big) {
+			  big=dum;
+			  imax=i;
+			}
+		  }
+		if (j != imax) {
+		  for (integer k=0;k<dims;k++) {
+			dum=a[imax][k];
+			a[imax][k]=a[j][k];
+			a[j][k]=dum;
+		  }
+		  pivotsign *= -1;
+		  rowscale[imax]=rowscale[j];
+		}
+		pivotrows[j]=imax;
+		if (a[j][j] == 0.0) a[j][j]=tiny;
+		if (j != (dims-1)) {
+		  dum=1.0/(a[j][j]);
+		  const numT* pivotrow=&a[j][j+1];
+		  for (integer i=j+1;i<dims;i++)
+			{
+			  const numT l=(a[i][j] *= dum);
+			  RowKernel<numT>::update(&a[i][j+1],pivotrow,l,dims-j-1);
+			}
+		}
+	  }
+  }
+
   template <integer dims, class NT>
   void LUSolve<dims,NT>::solve(vect& u)
   {
+	if (inverted) {SmallMatrix<dims,NT>::apply(*M,u); return;}
+
     matrix&		a(*M);
     numT		sum(0.);
 	integer		ii(-1);
@@ -146,10 +234,50 @@ namespace MODEL {
 	}
   }
 
+  template <integer dims, class NT>
+  void LUSolve<dims,NT>::solve_many(vect* u, counter n)
+  {
+	if (inverted)
+	  {
+		for (counter r=0;r<n;r++) SmallMatrix<dims,NT>::apply(*M,u[r]);
+		return;
+	  }
+
+    matrix&		a(*M);
+    numT		sum(0.);
+	// first nonzero element of each right-hand side, -1 if none yet
+	std::vector<integer>	ii(n,-1);
+
+	for (integer i=0;i<dims;i++)
+	  {
+		const integer ip=pivotrows[i];
+		for (counter r=0;r<n;r++)
+		  {
+			vect&	ur(u[r]);
+			sum=ur[ip];
+			ur[ip]=ur[i];
+
+			if (ii[r]>=0) for (integer j=ii[r];j<i;j++) sum -= a[i][j]*ur[j];
+			else if (sum!=0.0) ii[r]=i;
+
+			ur[i]=sum;
+		  }
+	  }
+	for (integer i(dims-1);i>=0;i--)
+	  for (counter r=0;r<n;r++)
+		{
+		  vect&	ur(u[r]);
+		  sum = ur[i];
+		  for (integer j(i+1);j<dims;j++) sum -= a[i][j]*ur[j];
+		  ur[i]=sum/a[i][i];
+		}
+  }
+
   template <integer dims, class NT>
   typename LUSolve<dims,NT>::numT	
   LUSolve<dims,NT>::det(void)
   {
+	if (inverted) return determinant;
 	numT	d(pivotsign);
 	for(integer j=0;j<dims;j++) d *= (*M)[j][j];
 	return d;
@@ -0,0 +1,98 @@
+/***************************************************************************
+                          modelinstance.h  -  a private copy of a model
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef MODELINSTANCE_H
+#define MODELINSTANCE_H
+
+#include "vectorfunction.h"
+#include "utility.h"
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+namespace MODEL {
+
+  /** A clone of a VectorFunction with parameters of its own.
+	  RootScan, Modulator and SSA change a parameter by writing through
+	  a pointer into the function, so two of them working on the same
+	  function (in two threads, or just two scans at once) change each
+	  other's parameters. Give each of them its own instance instead:
+
+	  \code
+	  ModelInstance<2> mine(vcsel);
+	  StepMod step(t,mine.get_function(),"current",0.,2.,10.);
+	  mine.get_parameter("current")=1.5;
+	  \endcode
+
+	  The clone has to define its own parameters: the copy constructor
+	  of the model must call define_parameter() again (see the tutorial).
+	  The constructor checks this, and throws if a parameter is missing
+	  or still points into the original.
+
+	  Parameters can be found by name, or, without the string compares,
+	  by a ParameterHandle from VectorFunction::get_handle(): it is
+	  valid for the original and for every instance of it.
+  */
+  template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
+  class ModelInstance
+  {
+  public:
+	typedef typename NT::vf vf;
+
+	ModelInstance(const vf& model) : f(model.clone())
+	{
+	  const map<string,number*>& theirs=model.get_parlist();
+	  const map<string,number*>& ours=f->get_parlist();
+	  for (map<string,number*>::const_iterator p=theirs.begin();p!=theirs.end();++p)
+		{
+		  map<string,number*>::const_iterator found=ours.find(p->first);
+		  if (found==ours.end() || found->second==p->second)
+			{
+			  delete f;
+			  throw std::logic_error("ModelInstance::The copy constructor of the model does not define parameter "+p->first);
+			}
+		}
+	  for (map<string,number*>::const_iterator p=ours.begin();p!=ours.end();++p)
+		pars.push_back(p->second);
+	}
+
+	~ModelInstance() {delete f;}
+
+	/** The clone */
+	vf& get_function(void) {return *f;}
+
+	/** A parameter of the clone, by name */
+	number& get_parameter(const string& name) {return f->get_parameter(name);}
+
+	/** A parameter of the clone, by handle */
+	number& get_parameter(ParameterHandle h)
+	{
+	  if (h<0 || h>=(ParameterHandle)pars.size())
+		throw std::logic_error("ModelInstance::Parameter not found");
+	  return *pars[h];
+	}
+
+	NO_COPY(ModelInstance);
+
+  private:
+	vf*		f;
+	/** The parameters of the clone, in handle order */
+	std::vector<number*>	pars;
+  };
+
+} // end namespace MODEL
+#endif
@@ -35,14 +35,14 @@ namespace MODEL {
 
   // Previously: template <integer dims, class NT = NumericTraits<number,dims> >
   template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
-  class NewtonRoot : public VectorFunction<dims,number,NT>
+  class NewtonRoot : public VectorFunction<dims,nelem,NT>
   {
   public:
 	typedef typename NT::number	numT;
 	typedef	typename NT::vect 	vect;
 	typedef typename NT::matrix matrix;
 	typedef typename NT::vf		vf;
-	typedef VectorFunction<dims,number,NT>				base;
+	typedef VectorFunction<dims,nelem,NT>				base;
 	
 	NewtonRoot(vf& f, bool own=false)
 	  : 	func( (own)? (f.clone()) : (&f) ), owned(own),
@@ -86,12 +86,31 @@ namespace MODEL {
 
   public:
 	static const	integer		maxiterations=10000;      // NRC: MAXITS
-	static const	numT	 	tolerancef=1.E-8;      	// NRC: TOLF
-	static const	numT		tolerancemin=1.E-6;     // NRC: TOLMIN
-	static const	numT		maxstep=100.;           // NRC: STPMX
-	static const	numT		tolerancex=1.E-8;		// NRC: TOLX
+	static const	numT	 	tolerancef;		      	// NRC: TOLF
+	static const	numT		tolerancemin;		    // NRC: TOLMIN
+	static const	numT		maxstep;		        // NRC: STPMX
+	static const	numT		tolerancex;				// NRC: TOLX
   };
 
+  // The tolerances are scaled to the precision of numT. tolerancef
+  // is compared squared to the norm of f, and f itself is only known
+  // to about eps.|f|, so it can not go below sqrt(eps)
+  template <integer dims, typename nelem, class NT >
+  const typename NewtonRoot<dims,nelem,NT>::numT
+  NewtonRoot<dims,nelem,NT>::tolerancef=Precision<numT>::sqrt_tolerance(1.E-8);
+
+  template <integer dims, typename nelem, class NT >
+  const typename NewtonRoot<dims,nelem,NT>::numT
+  NewtonRoot<dims,nelem,NT>::tolerancemin=Precision<numT>::tolerance(1.E-6);
+
+  template <integer dims, typename nelem, class NT >
+  const typename NewtonRoot<dims,nelem,NT>::numT
+  NewtonRoot<dims,nelem,NT>::maxstep=100.;
+
+  template <integer dims, typename nelem, class NT >
+  const typename NewtonRoot<dims,nelem,NT>::numT
+  NewtonRoot<dims,nelem,NT>::tolerancex=Precision<numT>::tolerance(1.E-8);
+
   // --- NON INLINED ---
 //   template <integer dims, typename nelem, class NT >
 //   NewtonRoot<dims,nelem,NT>::NewtonRoot(const NewtonRoot& nr) : ls(nr.ls),fdjac(nr.fdjac) {cout
@@ -179,11 +198,11 @@ namespace MODEL {
 		  {  	
 			// Besides, whenever we arrive here, something boogery has happened
 			testtol=0.0;
-			numT den=max(f,0.5*number(dims));
+			numT den=max(f,numT(0.5*dims));
 			numT tm(0.);
 			for (integer i=0;i<dims;i++)
 			  {
-				tm=abs(gradient[i])*max(abs(u[i]),number(1.0))/den;
+				tm=abs(gradient[i])*max(abs(u[i]),numT(1.0))/den;
 				if (tm > testtol) testtol=tm;
 			  }
 			wrongmin = (testtol < tolerancemin)||(!(norm(fvec)<tolerancef*tolerancef));
@@ -197,7 +216,7 @@ namespace MODEL {
 		testtol =0.0;	// check for converence on u
 		numT tm(0.);
 		for (integer i=0;i<dims;i++) {
-		  tm=(abs(u[i]-uold[i]))/max(abs(u[i]),number(1.0));
+		  tm=(abs(u[i]-uold[i]))/max(abs(u[i]),numT(1.0));
 		  if (tm > testtol) testtol=tm;
 		}
 		if (testtol < tolerancex)
@@ -25,6 +25,16 @@ namespace MODEL
 
   // Forward definitions
   template <typename numT, integer dims>
+  class FixedStorage;
+
+  template <typename numT, integer dims>
+  class HeapStorage;
+
+  /** The storage policy decides where the elements of a NumVector
+	  live. FixedStorage (the default) keeps them on the stack,
+	  HeapStorage uses a std::vector. @see numstorage.h */
+  template <typename numT, integer dims,
+			template <typename, integer> class Storage = FixedStorage>
   class NumericTraits;
 
   //Previously:  <integer dims, class NT>
@@ -42,7 +52,8 @@ namespace MODEL
   /**Traits classes for numerics
    */
 
-  template <typename numT, integer dims>
+  template <typename numT, integer dims,
+			template <typename, integer> class Storage>
   class NumericTraits
   {
   public:
@@ -51,9 +62,16 @@ namespace MODEL
 	/** Vector Type */
 	typedef NumVector< dims , numT, NumericTraits >				vect;
 	/** 2D Matrix Type */
-	typedef	NumVector< dims , vect, NumericTraits<vect,dims> >	matrix;
+	typedef	NumVector< dims , vect, NumericTraits<vect,dims,Storage> >	matrix;
 	/** And a tensor ... */
-	typedef	NumVector< dims , vect, NumericTraits<matrix,dims> > tensor;
+	typedef	NumVector< dims , vect, NumericTraits<matrix,dims,Storage> > tensor;
+
+	/** Where a NumVector of n elements keeps its data */
+	template <typename elem, integer n>
+	struct store
+	{
+	  typedef Storage<elem,n> type;
+	};
 
 		/** vect = f(vect)  */
 	typedef	VectorFunction< dims , numT, NumericTraits >		vf;
@@ -19,20 +19,61 @@
 #define NUMTYPES_H
 
 #include <complex>
+#include <limits>
 #include <float.h>
 
+/** The default scalar type is long double, which on x86 means x87
+	code and no SIMD at all. Configure with --enable-double or
+	--enable-float (or define MODEL_USE_DOUBLE or MODEL_USE_FLOAT) if
+	you do not need the extra bits. The templates also take the
+	element type as a parameter, so you can mix precisions in one
+	program as well. */
+#if defined(MODEL_USE_FLOAT)
+#define MODEL_NUMBER float
+#elif defined(MODEL_USE_DOUBLE)
+#define MODEL_NUMBER double
+#else
+#define MODEL_NUMBER long double
+#endif
+
 namespace MODEL {
 
   // simple
   typedef long counter;
   typedef signed int integer;
-  typedef long double number;
+  typedef MODEL_NUMBER number;
   typedef number	time;
   typedef std::complex<number> complex;
 
-  const	number	EPS=1.1E-19; // actual value is 1.0842E-19
+  const	number	EPS=std::numeric_limits<number>::epsilon(); // 1.0842E-19 for long double
   const	complex	I=complex(0,1);
 
+  /** Tolerances for a given precision. The defaults in the library
+	  were chosen for long double; for a shorter type they are loosened
+	  so that they can still be met. */
+  template <typename numT>
+  struct Precision
+  {
+	/** Machine epsilon */
+	static constexpr numT	eps(void) {return std::numeric_limits<numT>::epsilon();}
+
+	/** t, but never smaller than a few ulps */
+	static constexpr numT	tolerance(const numT& t)
+	{ return (t<numT(16)*eps())?numT(16)*eps():t; }
+
+	/** t, but never smaller than sqrt(eps): for quantities that are
+		only known to half the digits, like the position of a root */
+	static constexpr numT	sqrt_tolerance(const numT& t)
+	{ return (t<root(eps(),1,64))?root(eps(),1,64):t; }
+
+	/** Everything is constexpr, so the static tolerances defined with
+		it (NewtonRoot::tolerancex, ODESystem::DEFAULT_RELAX, ...) are
+		constants, set before any other global is initialised. Hence
+		this sqrt: n Newton steps from g, std::sqrt is not constexpr */
+	static constexpr numT	root(const numT& x, const numT& g, integer n)
+	{ return (n==0)?g:root(x,(g+x/g)/numT(2),n-1); }
+  };
+
 }
 #endif // NUMTYPES_H
 
@@ -0,0 +1,198 @@
+/***************************************************************************
+                          numexpr.h  -  expression templates for NumVector
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NUMEXPR_H
+#define NUMEXPR_H
+
+#include "numerictypes.h"
+#include "numerictraits.h"
+
+/** \file
+	Lazy arithmetic for NumVector (the poor man's PETE). An expression
+	like a+2.*b/3. does not compute anything: it builds a small tree
+	of nodes, which is only evaluated element by element when it is
+	assigned to (or used to construct) a NumVector. So the whole
+	expression is one loop, without temporary vectors.
+
+	Leaves (NumVector) are kept by reference, nodes by value. This
+	means you should never keep an expression around beyond the
+	statement that created it: assign it to a NumVector instead.
+*/
+
+namespace MODEL {
+
+  /** Base of all vector expressions. E is the actual expression
+	  (curiously recurring template), which should provide numT, N and
+	  a const operator[]. */
+  template <class E>
+  class VecExpr
+  {
+  public:
+	const E&	self(void) const {return static_cast<const E&>(*this);}
+  };
+
+  /** How to keep an operand inside a node: nodes by value... */
+  template <class E>
+  struct ExprStore
+  {
+	typedef const E type;
+  };
+
+  /** ...but vectors by reference. */
+  template <integer dims, typename nelem, class NT>
+  struct ExprStore< NumVector<dims,nelem,NT> >
+  {
+	typedef const NumVector<dims,nelem,NT>& type;
+  };
+
+  // The elementwise operations
+
+  struct ExprAdd
+  {
+	template <typename T>
+	static T apply(const T& a, const T& b) {return a+b;}
+  };
+
+  struct ExprSub
+  {
+	template <typename T>
+	static T apply(const T& a, const T& b) {return a-b;}
+  };
+
+  struct ExprMul
+  {
+	template <typename T>
+	static T apply(const T& a, const T& b) {return a*b;}
+  };
+
+  struct ExprDiv
+  {
+	template <typename T>
+	static T apply(const T& a, const T& b) {return a/b;}
+  };
+
+  /** vector op vector */
+  template <class L, class R, class Op>
+  class VecBinary : public VecExpr< VecBinary<L,R,Op> >
+  {
+  public:
+	typedef typename L::numT	numT;
+	static const integer N=L::N;
+
+	VecBinary(const L& left, const R& right) : l(left), r(right) {}
+
+	numT	operator[](integer i) const {return Op::apply(l[i],r[i]);}
+
+  private:
+	typename ExprStore<L>::type l;
+	typename ExprStore<R>::type r;
+  };
+
+  /** scalar op vector */
+  template <class E, class Op>
+  class VecScalarLeft : public VecExpr< VecScalarLeft<E,Op> >
+  {
+  public:
+	typedef typename E::numT	numT;
+	static const integer N=E::N;
+
+	VecScalarLeft(const numT& scalar, const E& expr) : s(scalar), e(expr) {}
+
+	numT	operator[](integer i) const {return Op::apply(s,e[i]);}
+
+  private:
+	const numT s;
+	typename ExprStore<E>::type e;
+  };
+
+  /** vector op scalar */
+  template <class E, class Op>
+  class VecScalarRight : public VecExpr< VecScalarRight<E,Op> >
+  {
+  public:
+	typedef typename E::numT	numT;
+	static const integer N=E::N;
+
+	VecScalarRight(const E& expr, const numT& scalar) : e(expr), s(scalar) {}
+
+	numT	operator[](integer i) const {return Op::apply(e[i],s);}
+
+  private:
+	typename ExprStore<E>::type e;
+	const numT s;
+  };
+
+  /** -vector */
+  template <class E>
+  class VecNegate : public VecExpr< VecNegate<E> >
+  {
+  public:
+	typedef typename E::numT	numT;
+	static const integer N=E::N;
+
+	VecNegate(const E& expr) : e(expr) {}
+
+	numT	operator[](integer i) const {return -e[i];}
+
+  private:
+	typename ExprStore<E>::type e;
+  };
+
+  // The operators themselves. They only build the tree.
+
+  template <class L, class R>
+  inline
+  VecBinary<L,R,ExprAdd>
+  operator+(const VecExpr<L>& l, const VecExpr<R>& r)
+  {
+	return VecBinary<L,R,ExprAdd>(l.self(),r.self());
+  }
+
+  template <class L, class R>
+  inline
+  VecBinary<L,R,ExprSub>
+  operator-(const VecExpr<L>& l, const VecExpr<R>& r)
+  {
+	return VecBinary<L,R,ExprSub>(l.self(),r.self());
+  }
+
+  template <class E>
+  inline
+  VecScalarLeft<E,ExprMul>
+  operator*(const typename E::numT& s, const VecExpr<E>& e)
+  {
+	return VecScalarLeft<E,ExprMul>(s,e.self());
+  }
+
+  template <class E>
+  inline
+  VecScalarRight<E,ExprDiv>
+  operator/(const VecExpr<E>& e, const typename E::numT& s)
+  {
+	return VecScalarRight<E,ExprDiv>(e.self(),s);
+  }
+
+  template <class E>
+  inline
+  VecNegate<E>
+  operator-(const VecExpr<E>& e)
+  {
+	return VecNegate<E>(e.self());
+  }
+
+} // end namespace MODEL
+#endif
@@ -0,0 +1,60 @@
+/***************************************************************************
+                          numstorage.h  -  storage policies for NumVector
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NUMSTORAGE_H
+#define NUMSTORAGE_H
+
+#include <array>
+#include <vector>
+#include "numerictypes.h"
+
+/** Alignment (in bytes) of the fixed size storage. 16 is enough for
+	SSE and for long double, define it to 32 on the command line if
+	you want AVX aligned rows. */
+#ifndef MODEL_ALIGNMENT
+#define MODEL_ALIGNMENT 16
+#endif
+
+namespace MODEL {
+
+  /** Storage on the stack: the size is known at compile time anyway,
+	  so there is no need to go to the heap for every temporary. A
+	  matrix made out of these is one contiguous block, with each row
+	  aligned on MODEL_ALIGNMENT. This is the default.
+  */
+  template <typename numT, integer dims>
+  class alignas(MODEL_ALIGNMENT) FixedStorage : public std::array<numT,dims>
+  {
+  public:
+	FixedStorage() {}
+	FixedStorage(const numT& init) {this->fill(init);}
+  };
+
+  /** The old storage: a std::vector resized to dims on
+	  construction. Use this if your dims are so large that they do
+	  not fit on the stack anymore.
+  */
+  template <typename numT, integer dims>
+  class HeapStorage : public std::vector<numT>
+  {
+  public:
+	HeapStorage() : std::vector<numT>(dims) {}
+	HeapStorage(const numT& init) : std::vector<numT>(dims,init) {}
+  };
+
+} // end namespace MODEL
+#endif
@@ -18,15 +18,22 @@
 #ifndef NUMVECTOR_H
 #define NUMVECTOR_H
 
-#include <vector>
 #include <stdexcept>
 #include "numerictypes.h"
 #include "numerictraits.h"
+#include "numstorage.h"
+#include "numexpr.h"
+
+/** Bounds checking on NumVector::operator[]. It costs a branch (and
+	the exception handling code) in every inner loop, so it is off by
+	default: configure with --enable-boundscheck or --enable-debug, or
+	define MODEL_CHECK_BOUNDS yourself. */
+#if defined(BZ_DEBUG) && !defined(MODEL_CHECK_BOUNDS)
+#define MODEL_CHECK_BOUNDS
+#endif
 
 namespace MODEL {
 
-	// prototyping friends - trying to fix error by defining template frined first
-
 // Previously: template<integer dims, class NT>
 template <integer dims, typename nelem, class NT >
 	typename NT::number
@@ -43,96 +50,50 @@ template <integer dims, typename nelem, class NT >
 	  return sqrt(norm(nv));
 	}
 
-// Previously: template<integer dims, class NT>
-template <integer dims, typename nelem, class NT >
-	inline
-	NumVector<dims, nelem, NT>
-	operator*(const typename NT::number& nvmul, const NumVector<dims,nelem,NT>& nv)
-	{
-	  NumVector<dims,nelem,NT> res(nv);
-	  return res*=nvmul;
-	}
-
-// Previously: template<integer dims, class NT>
-template <integer dims, typename nelem, class NT >
-	inline
-	NumVector<dims,nelem,NT>
-	operator-(const NumVector<dims,nelem,NT>& m)
-	{
-	  NumVector<dims,nelem,NT>	v(m);
-	  const typename NT::number	minus(-1.);
-	  v*=minus;
-	  return v;
-	}
-
-
-
-template <integer dims, typename nelem, class NT >
-	inline
-	NumVector<dims, nelem, NT>
-	operator/(const NumVector<dims,nelem,NT>& nvmul, const typename NT::number&  nv)
-	{
-	  NumVector<dims,nelem,NT> res(nvmul);
-	  return res/=nv;
-	}
-
-// Previously: template<integer dims, class NT>
-template <integer dims, typename nelem, class NT >
-	inline
-	NumVector<dims,nelem,NT>
-	operator+(const  NumVector<dims,nelem,NT>& nvmul, const NumVector<dims,nelem,NT>& nv)
-	{
-	  NumVector<dims,nelem,NT> res(nv);
-	  return res+=nvmul;
-	}
-
-template <integer dims, typename nelem, class NT >
-	inline
-	NumVector<dims,nelem,NT>
-	operator-(const  NumVector<dims,nelem,NT>& nvmul, const NumVector<dims,nelem,NT>& nv)
-	{
-	  NumVector<dims,nelem,NT> res(nvmul);
-	  return res-=nv;
-	}
-
-/** Multiplier for real types
+/** Multiplier for real types: the scalar product. Works on
+	vectors as well as on any expression of vectors.
   */
-
- // Previously: template<integer dims, class NT>
- template <integer dims, typename nelem, class NT >
+ template <class L, class R>
 	inline
-	typename NT::number
-	operator*(const NumVector<dims,nelem,NT>& nv,const NumVector<dims,nelem,NT>& nvmul)
+	typename L::numT
+	operator*(const VecExpr<L>& nv,const VecExpr<R>& nvmul)
 	{
-	  typename NT::number r=0.0;
-	  for(integer i=0;i<dims;i++) r += nv[i]*nvmul[i]; return r;
+	  const L& l=nv.self();
+	  const R& r=nvmul.self();
+	  typename L::numT r0=0.0;
+	  for(integer i=0;i<L::N;i++) r0 += l[i]*r[i];
+	  return r0;
 	}
 
 
   /**Class which adds functionality to Vector in case
-	 the type of data is numeric.
+	 the type of data is numeric. The elements are kept in the
+	 storage selected by NT (by default a fixed size array on the
+	 stack, see numstorage.h). Arithmetic (+, -, scalar * and /) is
+	 lazy, see numexpr.h.
 	 */
   // Previously: template<integer dims, class NT = NumericTraits<number, dims> >
   template<integer dims, typename nelem=number, class NT = NumericTraits<nelem,dims> >
-	class NumVector : public std::vector<typename NT::number>
+	class NumVector : public NT::template store<typename NT::number,dims>::type,
+					  public VecExpr< NumVector<dims,nelem,NT> >
   {
 	public:
 	typedef	typename	NT::number				number;
 	typedef	typename	NT::number				numT;	// old code
 	typedef	typename	NT::vect				vect;   // make life easier
-	typedef	std::vector<number>	base;  	// base type
+	typedef	typename	NT::template store<number,dims>::type	base;  	// base type
+	static const integer	N=dims;								// for the expressions
 
-	/** Constuctor automatically resize for speed gain */
-	NumVector(const numT& init=0.)
-	{this->resize(dims,init);}
-	virtual ~NumVector() {}
+	/** Constuctor fills in all elements */
+	NumVector(const numT& init=0.) : base(init) {}
 
-	/** Constructor to copy everything from an array
-		resize has to be called, otherwise the objects[] do not exist !
-	*/
+	/** Not virtual: nothing derives from us, and a vtable would
+		break up the contiguous rows of a matrix */
+	~NumVector() {}
+
+	/** Constructor to copy everything from an array */
 	NumVector(const numT Tarray[])
-	{ 	this->resize(dims);
-		for(integer i=0;i<dims;i++) (*this)[i]=Tarray[i];}
+	{ 	for(integer i=0;i<dims;i++) (*this)[i]=Tarray[i];}
 
 	/** "virtual" copy constructor */
 	NumVector*	clone(void){return new NumVector(*this);}
@@ -144,46 +105,59 @@ template <integer dims, typename nelem, class NT >
 	const NumVector&	operator=(const NumVector& vassign)
 	{ if (this!=&vassign) base::operator=(vassign); return *this; }
 
-	/** Overloaded accessor to catch errors (bound checking) */
+	/** Evaluates an expression in one go. Elements are only read at
+		the index they are written to, so x=y-x is safe. */
+	template <class E>
+	NumVector(const VecExpr<E>& expr)
+	{ const E& e=expr.self(); for(integer i=0;i<dims;i++) base::operator[](i)=e[i]; }
+
+	/** Same, for assignment */
+	template <class E>
+	const NumVector&	operator=(const VecExpr<E>& expr)
+	{ const E& e=expr.self(); for(integer i=0;i<dims;i++) base::operator[](i)=e[i]; return *this; }
+
+	/** Element access. Only checks the bounds when MODEL_CHECK_BOUNDS
+		is defined (see above), otherwise this compiles down to a plain
+		array access. */
 	const numT&	operator[](integer i) const
 	{
-	  // removed bounds checking for speed
-	  return std::vector<typename NT::number>::operator[](i);
-	  // if (i>=0&&i<dims) return std::vector<typename NT::number>::operator[](i);
-	  // else throw std::logic_error("array value out of bounds");
-	  return (*this)[0]; // this should _never_ happen
+#ifdef MODEL_CHECK_BOUNDS
+	  if (i<0||i>=dims) throw std::logic_error("array value out of bounds");
+#endif
+	  return base::operator[](i);
 	}
 
-	/** Overloaded accessor to catch errors (bound checking) */
+	/** Element access, see above */
 	numT&	operator[](integer i)
 	{
-	  if (i>=0&&i<dims) return std::vector<typename NT::number>::operator[](i);
-	  else throw std::logic_error("array value out of bounds");
-	  return (*this)[0]; // this should _never_ happen
+#ifdef MODEL_CHECK_BOUNDS
+	  if (i<0||i>=dims) throw std::logic_error("array value out of bounds");
+#endif
+	  return base::operator[](i);
 	}
 
 	// Arithmetic Operators
-	// This will be taken over by PETE, undoubtedly
+	// The binary ones build expressions, see numexpr.h
 
 	NumVector& operator+=(const NumVector& nvplus)
-	{ for(integer i=0;i<dims;i++) (*this)[i]+=nvplus[i]; return *this; }
+	{ for(integer i=0;i<dims;i++) base::operator[](i)+=nvplus[i]; return *this; }
 
 	NumVector& operator-=(const NumVector& nvmin)
-	{ for(integer i=0;i<dims;i++) (*this)[i]-=nvmin[i]; return *this; }
-
-	NumVector& operator/=(const numT& nvdiv)
-	{ for(integer i=0;i<dims;i++) (*this)[i]/=nvdiv; return *this; }
-
-	NumVector& operator*=(const numT& nvmul)
-	{ for(integer i=0;i<dims;i++) (*this)[i] *= nvmul; return *this; }
+	{ for(integer i=0;i<dims;i++) base::operator[](i)-=nvmin[i]; return *this; }
 
-	friend NumVector operator*<dims, nelem, NT>(const numT& nvmul, const NumVector& nv);
-	friend NumVector operator/<dims, nelem, NT>(const NumVector& nvmul, const numT& nv);
+	template <class E>
+	NumVector& operator+=(const VecExpr<E>& expr)
+	{ const E& e=expr.self(); for(integer i=0;i<dims;i++) base::operator[](i)+=e[i]; return *this; }
 
+	template <class E>
+	NumVector& operator-=(const VecExpr<E>& expr)
+	{ const E& e=expr.self(); for(integer i=0;i<dims;i++) base::operator[](i)-=e[i]; return *this; }
 
-	friend NumVector operator+<dims, nelem, NT>(const NumVector& nvmul, const NumVector& nv);
+	NumVector& operator/=(const numT& nvdiv)
+	{ for(integer i=0;i<dims;i++) base::operator[](i)/=nvdiv; return *this; }
 
-	friend NumVector operator-<dims, nelem, NT>(const NumVector& nvmul, const NumVector& nv);
+	NumVector& operator*=(const numT& nvmul)
+	{ for(integer i=0;i<dims;i++) base::operator[](i) *= nvmul; return *this; }
 
 	/** Computes the scalar product. Wrong for complex types */
 	/*
@@ -194,14 +168,6 @@ template <integer dims, typename nelem, class NT >
 	//		friend real operator*(const NumVector< std::complex<numT> ,dims>& nv,
 	//											const NumVector< std::complex<numT>,dims>& nvmul);
 
-	/** Computes the norm of a vector.
-	 */
-	friend numT norm<dims,nelem,NT>(const NumVector& nv) ;
-
-	/** Slightly more effort: the length. */
-	friend numT length<dims,nelem,NT>(const NumVector& nv);
-
-	friend NumVector operator-<dims,nelem,NT>(const NumVector& m);
   };
 
 
@@ -119,11 +119,11 @@ namespace MODEL {
 	  RootScan<dims,nelem,NT> find(*deter);
 	  find.add_start(fromhere);
 	  ScanList<dims,nelem,NT> roots=find.scan(0.,1.,1);
-	  ScanList<dims,nelem,NT> goodone=roots.select(RootScan<dims>::stable);
+	  ScanList<dims,nelem,NT> goodone=roots.select(RootScan<dims,nelem,NT>::stable);
 	  
-	  if (goodone.get_data()[0.].size()>0)
+	  if (goodone.count(0.)>0)
 		{	  
-		  current=goodone.get_data()[0.].front()[0];
+		  current=goodone.get_vector(goodone.find(0.),0);
 		  cerr << "ODESystem: started at " << current << endl;
 		}
 	  else
@@ -137,16 +137,16 @@ namespace MODEL {
 	/** Calculate statitionairy value for current parameters. Returns
 		time taken to relax Note: You cannot relax to a level smaller than the
 		noise level.  @param goal accurary required. */
-	time relax(number goal=DEFAULT_RELAX);
+	time relax(numT goal=DEFAULT_RELAX);
 	/** Use this function to relax to a stable state, without using
 		the TimeFrame */
-	time relax_independent(number goal=DEFAULT_RELAX);
+	time relax_independent(numT goal=DEFAULT_RELAX);
 	
 	/** Scanning a certain parameter */
 
   private:
 	// Variables
-	static const number DEFAULT_RELAX=1E-7;
+	static const numT DEFAULT_RELAX;
 
 	/** Initial values */
 	vect		init;
@@ -166,6 +166,10 @@ namespace MODEL {
   // Member Functions
   //--------------------------------------------------------------------------------
 
+  template<integer dims, typename nelem, class NT >
+  const typename ODESystem<dims,nelem,NT>::numT
+  ODESystem<dims,nelem,NT>::DEFAULT_RELAX=Precision<numT>::tolerance(1E-7);
+
   template<integer dims, typename nelem, class NT >
   ODESystem<dims,nelem,NT>::ODESystem( 	TimeFrame& T, vf& detpart, vf& stochpart, vect& initial,
 										Integration it, time res) :
@@ -193,6 +197,17 @@ namespace MODEL {
 
 	  case Heun: integ = new IHeun<dims,nelem,NT>(detpart,stochpart);
 		break;
+
+	  case MilshteinDiag: integ = new IMilshtein<dims,nelem,NT>(detpart,stochpart,true);
+		break;
+	  case DormandPrince: integ = new IDormandPrince<dims,nelem,NT>(detpart,stochpart);
+		break;
+	  case Rosenbrock: integ = new IRosenbrock<dims,nelem,NT>(detpart,stochpart);
+		break;
+	  case StochasticRK: integ = new IStochasticRK<dims,nelem,NT>(detpart,stochpart);
+		break;
+	  case HeunIto: integ = new IHeunIto<dims,nelem,NT>(detpart,stochpart);
+		break;
 	  
 	  default:	throw std::logic_error("ODESystem::Integration method not implemented");
 		break;
@@ -270,6 +285,10 @@ namespace MODEL {
 		break;
 	  case RungeKutta: integ = new IRungeKutta<dims,nelem,NT>(detpart,detpart);
 		break;
+	  case DormandPrince: integ = new IDormandPrince<dims,nelem,NT>(detpart,detpart);
+		break;
+	  case Rosenbrock: integ = new IRosenbrock<dims,nelem,NT>(detpart,detpart);
+		break;
 	  
 	  default:	throw std::logic_error("ODESystem::Integration method not implemented");
 		break;
@@ -288,12 +307,12 @@ namespace MODEL {
 
   template<integer dims, typename nelem, class NT >
   time 
-  ODESystem<dims,nelem,NT>::relax_independent(number goal)
+  ODESystem<dims,nelem,NT>::relax_independent(numT goal)
   {
 	// This will become a RungeKutta
 	IRungeKutta<dims,nelem,NT> massage(*deter,*stoch); 
 	ODESystem& system(*this); // alias for readability
-	number change(0.);
+	numT change(0.);
 	time chrono=0.;
 	vect lastvalue(system());
 
@@ -307,7 +326,7 @@ namespace MODEL {
 		change=0.;
 		for (counter i=0;i<dims;i++)
 		  {
-			number converge=abs((newvalue[i]-lastvalue[i])/lastvalue[i]);
+			numT converge=abs((newvalue[i]-lastvalue[i])/lastvalue[i]);
 			if(converge>change) change=converge; // find maximal change
 		  }
 		lastvalue=newvalue;
@@ -321,10 +340,10 @@ namespace MODEL {
   //--------------------------------------------------------------------------------
   template<integer dims, typename nelem, class NT >
   time 
-  ODESystem<dims,nelem,NT>::relax(number goal)
+  ODESystem<dims,nelem,NT>::relax(numT goal)
   {
 	ODESystem& system(*this); // alias for readability
-	number change(0.);
+	numT change(0.);
 	TimeFrame& t=get_timeframe();
 	time init=t;
 	vect converge(0.),lastvalue(system());
@@ -339,7 +358,7 @@ namespace MODEL {
 		change=0.;
 		for (counter i=0;i<dims;i++)
 		  {
-			number converge=abs((newvalue[i]-lastvalue[i])/lastvalue[i]);
+			numT converge=abs((newvalue[i]-lastvalue[i])/lastvalue[i]);
 			if(converge>change) change=converge; // find maximal change
 		  }
 		lastvalue=newvalue;
@@ -40,6 +40,10 @@ namespace MODEL{
   typedef number& Parameter;
   /** Even uglier... for use when they cannot be init.*/
   typedef number* ParameterP;
+  /** A parameter by position instead of by name: see
+	  VectorFunction::get_handle(). The same handle finds the same
+	  parameter in every clone of a function. */
+  typedef counter ParameterHandle;
 }
 #endif
 
@@ -17,6 +17,10 @@
  ***************************************************************************/
 
 #include "probe.h"
+#include <cstring>
+#include <stdint.h>
+#include <stdexcept>
+#include <cmath>
 
 namespace MODEL
 {
@@ -53,69 +57,245 @@ namespace MODEL
   }
   
 
-  //Probe
+  // TextProbeWriter
 
-  Probe::Probe(TimeFrame & T, const string& fn) 
-	: TickTock(T,T.get_dt()), n(fn), out(NULL)
+  TextProbeWriter::TextProbeWriter(const string& fn)
+	: out(new ofstream(fn.c_str())), own(true)
   {
-	var_data=new data_list;
+	(*out) << "# Probe Output" << '\n';
   }
 
-  Probe::Probe(TimeFrame & T, ostream& os) 
-	: TickTock(T,T.get_dt()), out(&os), data_is_here(false)
+  TextProbeWriter::TextProbeWriter(ostream& os)
+	: out(&os), own(false)
   {
-	var_data=new data_list;
+	(*out) << "# Probe Output" << '\n';
   }
 
-  Probe::~Probe()
-  { 
-	bool no_out=false;  
-	if(no_out=(out==NULL)) out=new ofstream(n.c_str());
-	  
-	(*out) << "# Probe Output" <<endl;
-	  
-	for( data_list::iterator printer=var_data->begin();
-		 printer!=var_data->end();
-		 printer++)
+  TextProbeWriter::~TextProbeWriter()
+  {
+	finish();
+	if(own) delete out;
+  }
+
+  void
+  TextProbeWriter::write(const number* d, counter n)
+  {
+	// no endl: flushing every line is what made the old one slow
+	for(counter i=0;i<n;i++) (*out) << d[i] << "\t";
+	(*out) << '\n';
+  }
+
+  void
+  TextProbeWriter::finish(void)
+  {
+	out->flush();
+  }
+
+  // BinaryProbeWriter
+
+  const char BinaryProbeWriter::magic[8]={'M','O','D','E','L','P','R','B'};
+
+  BinaryProbeWriter::BinaryProbeWriter(const string& fn, counter buffer)
+	: out(new ofstream(fn.c_str(),ios::out|ios::binary)), own(true),
+	  buf(buffer), used(0)
+  {
+	header();
+  }
+
+  BinaryProbeWriter::BinaryProbeWriter(ostream& os, counter buffer)
+	: out(&os), own(false), buf(buffer), used(0)
+  {
+	header();
+  }
+
+  BinaryProbeWriter::~BinaryProbeWriter()
+  {
+	finish();
+	if(own) delete out;
+  }
+
+  void
+  BinaryProbeWriter::header(void)
+  {
+	const uint32_t head[2]={version,sizeof(number)};
+	put(magic,sizeof(magic));
+	put(head,sizeof(head));
+  }
+
+  void
+  BinaryProbeWriter::write(const number* d, counter n)
+  {
+	const uint32_t length=n;
+	put(&length,sizeof(length));
+	put(d,n*sizeof(number));
+  }
+
+  void
+  BinaryProbeWriter::put(const void* p, counter bytes)
+  {
+	const char* from=static_cast<const char*>(p);
+	while(bytes>0)
 	  {
-		if (printer->size()>1)
+		if(used==(counter)buf.size())
 		  {
-			for ( data_record::iterator clack=printer->begin();
-				  clack!=(printer->end());
-				  clack++)
-			  (*out) << (*clack) << "\t";
-			(*out) << endl;
+			out->write(&buf[0],used);
+			used=0;
 		  }
-		
+		counter chunk=buf.size()-used;
+		if(chunk>bytes) chunk=bytes;
+		memcpy(&buf[used],from,chunk);
+		used+=chunk; from+=chunk; bytes-=chunk;
 	  }
+  }
 
-	if(no_out) delete out;	
-	delete var_data;
+  void
+  BinaryProbeWriter::finish(void)
+  {
+	if(used>0) out->write(&buf[0],used);
+	used=0;
+	out->flush();
+  }
+
+  // ReducingProbeWriter
+
+  ReducingProbeWriter::ReducingProbeWriter(ProbeWriter& t, counter e, integer w)
+	: target(&t), every(e), what(w), count(0), width(0)
+  {
+	if(every<1) throw std::logic_error("ReducingProbeWriter::Need at least one record per interval");
+  }
+
+  ReducingProbeWriter::~ReducingProbeWriter()
+  {
+	// no exceptions out of a destructor
+	try {if(count>0) emit();}
+	catch(std::exception& e) {cerr << "ReducingProbeWriter: " << e.what() << endl;}
+	catch(...) {cerr << "ReducingProbeWriter: unknown exception" << endl;}
+  }
+
+  void
+  ReducingProbeWriter::write(const number* d, counter n)
+  {
+	if(n<1) throw std::logic_error("ReducingProbeWriter::A record needs at least the time");
+	if(count>0 && n!=width) emit();
+	const counter vars=n-1; // the first is the time
+	if(count==0)
+	  {
+		width=n;
+		sum.assign(vars,0.);
+		sumsq.assign(vars,0.);
+		lo.assign(d+1,d+n);
+		hi.assign(d+1,d+n);
+	  }
+	for(counter i=0;i<vars;i++)
+	  {
+		const number x=d[i+1];
+		sum[i]+=x;
+		sumsq[i]+=x*x;
+		if(x<lo[i]) lo[i]=x;
+		if(x>hi[i]) hi[i]=x;
+	  }
+	last.assign(d+1,d+n);
+	t=d[0];
+	if(++count==every) emit();
+  }
+
+  void
+  ReducingProbeWriter::emit(void)
+  {
+	out.clear();
+	out.push_back(t);
+	for(counter i=0;i<width-1;i++)
+	  {
+		if(what & Mean) out.push_back(sum[i]/count);
+		if(what & Min) out.push_back(lo[i]);
+		if(what & Max) out.push_back(hi[i]);
+		if(what & RMS) out.push_back(sqrt(sumsq[i]/count));
+		if(what & Last) out.push_back(last[i]);
+	  }
+	target->write(&out[0],out.size());
+	count=0;
+  }
+
+  void
+  ReducingProbeWriter::finish(void)
+  {
+	if(count>0) emit();
+	target->finish();
+  }
+
+  // BinaryProbeReader
+
+  BinaryProbeReader::BinaryProbeReader(istream& is) : in(&is)
+  {
+	char m[8];
+	uint32_t head[2];
+	in->read(m,sizeof(m));
+	in->read(reinterpret_cast<char*>(head),sizeof(head));
+	if(!(*in) || memcmp(m,BinaryProbeWriter::magic,sizeof(m))!=0)
+	  throw std::logic_error("BinaryProbeReader::Not a binary probe file");
+	if(head[0]!=BinaryProbeWriter::version)
+	  throw std::logic_error("BinaryProbeReader::Unknown version");
+	if(head[1]!=sizeof(number))
+	  throw std::logic_error("BinaryProbeReader::The file was written with another number type");
+  }
+
+  bool
+  BinaryProbeReader::read(vector<number>& record)
+  {
+	uint32_t length;
+	if(!in->read(reinterpret_cast<char*>(&length),sizeof(length))) return false;
+	record.resize(length);
+	if(length>0 && !in->read(reinterpret_cast<char*>(&record[0]),length*sizeof(number)))
+	  throw std::logic_error("BinaryProbeReader::Truncated record");
+	return true;
+  }
+
+  //Probe
+
+  Probe::Probe(TimeFrame & T, const string& fn) 
+	: TickTock(T,T.get_dt()), writer(new TextProbeWriter(fn)), own(true),
+	  data_is_here(false)
+  {
+  }
+
+  Probe::Probe(TimeFrame & T, ostream& os) 
+	: TickTock(T,T.get_dt()), writer(new TextProbeWriter(os)), own(true),
+	  data_is_here(false)
+  {
+  }
+
+  Probe::Probe(TimeFrame & T, ProbeWriter& w) 
+	: TickTock(T,T.get_dt()), writer(&w), own(false), data_is_here(false)
+  {
+  }
+
+  Probe::~Probe()
+  { 
+	// no exceptions out of a destructor
+	try {writer->finish();}
+	catch(std::exception& e) {cerr << "Probe: " << e.what() << endl;}
+	catch(...) {cerr << "Probe: unknown exception" << endl;}
+	if(own) delete writer;
   }
 
   void 
   Probe::tick()
   {
 	data_is_here=false;
-	temp_data = new data_record;
-	temp_data->push_back(get_time());
+	record.clear();
+	record.push_back(get_time());
 
 	probe();
 
-	// the last element is the time
-	if(data_is_here) 
-	  {var_data->push_back(*temp_data); }
-	delete temp_data; temp_data=NULL;
-
+	// the first element is the time
+	if(data_is_here) writer->write(&record[0],record.size());
   }
 
   void 
   Probe::add_data(const number& d)
   {
-	// As it is always push_back which is used, we just have to
-	// look at the latest addition
 	data_is_here=true;
-	temp_data->push_back(d);
+	record.push_back(d);
   }
 
 } // end namespace
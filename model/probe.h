@@ -66,8 +66,148 @@ namespace MODEL
 	ostream* out;
   };
   
+  /** Where a Probe sends its records: one record (the time, then the
+	  data added in probe()) per tick with data. The records are
+	  written while the simulation runs, so a long run does not keep
+	  its trajectory in memory. */
+  class ProbeWriter
+  {
+  public:
+	ProbeWriter() {}
+	virtual ~ProbeWriter() {}
+
+	/** Write one record of n numbers */
+	virtual void write(const number* d, counter n)=0;
+
+	/** Write out whatever is still buffered */
+	virtual void finish(void) {}
+
+	NO_COPY(ProbeWriter);
+  };
+
+  /** The gnuplot text Probe always wrote: a "# Probe Output" line, then
+	  one line per record, every number followed by a tab. */
+  class TextProbeWriter : public ProbeWriter
+  {
+  public:
+	/** Write to a file */
+	TextProbeWriter(const string& fn);
+	/** Write to an ostream (e.g. cout) */
+	TextProbeWriter(ostream& os);
+	~TextProbeWriter();
+
+	virtual void write(const number* d, counter n);
+	virtual void finish(void);
+
+  private:
+	ostream* out;
+	bool own;
+  };
+
+  /** Binary records, for long runs: no formatting while running, and
+	  every digit of the numbers (the text has six). The file
+	  starts with a header: the 8 characters "MODELPRB", then the
+	  format version and sizeof(number) as 32 bit integers. Every record
+	  is its length n (32 bit) followed by n numbers, exactly as they
+	  are in memory. Everything is in the byte order of the machine
+	  that wrote it.
+
+	  The records are collected in a buffer of a fixed size, which is
+	  written out when it is full. Turn the file into the text of
+	  TextProbeWriter with probe2text (in tutorial/), or read it
+	  yourself with BinaryProbeReader.
+  */
+  class BinaryProbeWriter : public ProbeWriter
+  {
+  public:
+	/** Write to a file
+		@param buffer the size of the buffer in bytes */
+	BinaryProbeWriter(const string& fn, counter buffer=65536);
+	/** Write to an ostream, which should be opened with ios::binary */
+	BinaryProbeWriter(ostream& os, counter buffer=65536);
+	~BinaryProbeWriter();
+
+	virtual void write(const number* d, counter n);
+	virtual void finish(void);
+
+	static const char		magic[8];
+	static const unsigned	version=1;
+
+  private:
+	void header(void);
+	void put(const void* p, counter bytes);
+
+	ostream* out;
+	bool own;
+	vector<char> buf;
+	counter used;
+  };
+
+  /** Cuts the output down: every `every' records it writes one, with
+	  for each variable the statistics you ask for over those records,
+	  all computed as the records come in:
+
+	  \code
+	  TextProbeWriter file("run.dat");
+	  ReducingProbeWriter r(file,1000,ReducingProbeWriter::Min|ReducingProbeWriter::Max);
+	  ODEProbe<2> p(T,sys,r);
+	  \endcode
+
+	  keeps the envelope of a fast oscillation with a thousandth of the
+	  output. A reduced record is the time of the last record in it,
+	  and then per variable the chosen statistics in the order of the
+	  enum (mean, minimum, maximum, rms, last value). When the length
+	  of the records changes, or at finish(), the records so far are
+	  written out as a (shorter) interval of their own.
+  */
+  class ReducingProbeWriter : public ProbeWriter
+  {
+  public:
+	enum Reduction {Mean=1, Min=2, Max=4, RMS=8, Last=16};
+
+	/** @param target where the reduced records go
+		@param every the number of records per reduced record
+		@param what the statistics to write, or'ed together */
+	ReducingProbeWriter(ProbeWriter& target, counter every, integer what=Mean);
+	~ReducingProbeWriter();
+
+	virtual void write(const number* d, counter n);
+	virtual void finish(void);
+
+  private:
+	void emit(void);
+
+	ProbeWriter* target;
+	counter every;
+	integer what;
+	/** The records in this interval, and their length */
+	counter count;
+	counter width;
+	number t;
+	vector<number> sum,sumsq,lo,hi,last,out;
+  };
+
+  /** Reads back what a BinaryProbeWriter wrote. The number type has
+	  to be the one of the writer, the constructor throws if it is
+	  not. */
+  class BinaryProbeReader
+  {
+  public:
+	BinaryProbeReader(istream& is);
+
+	/** The next record, false at the end of the file */
+	bool read(vector<number>& record);
+
+	NO_COPY(BinaryProbeReader);
+
+  private:
+	istream* in;
+  };
+
+  //------------------------------------------------------------
   /** Class to probe variables and parameters.
-	  It writes out the collected data into a file upon destruction.
+	  It writes out the collected data into a file as it goes, through
+	  a ProbeWriter: text by default, BinaryProbeWriter for long runs.
 
 	  You just have to redefine probe() to write out the needed data
 	  using add_data(). You can add as many datapoints as you like at
@@ -93,6 +233,13 @@ namespace MODEL
 	*/
 	Probe(TimeFrame & T, ostream& os);
 
+	/** Constructor with a writer of your own (e.g. a
+		BinaryProbeWriter). It has to outlive the probe.
+		@param T the timeframe to which the probe should be added.
+		@param w the writer
+	*/
+	Probe(TimeFrame & T, ProbeWriter& w);
+
 	virtual ~Probe();	
 
 	virtual void tick();
@@ -105,12 +252,11 @@ namespace MODEL
 	NO_COPY(Probe);
 	
   private:
-	string n;
-	ostream* out;
+	ProbeWriter* writer;
+	bool own;
 
 	bool data_is_here;
-	data_list* var_data;
-	data_record* temp_data;
+	data_record record;
   };
   
   //------------------------------------------------------------
@@ -129,6 +275,8 @@ class ODEProbe : public Probe
 
 	ODEProbe(TimeFrame& T, system& s, ostream& o) 
 	  : Probe(T,o), my_sys(&s){}
+	ODEProbe(TimeFrame& T, system& s, ProbeWriter& w) 
+	  : Probe(T,w), my_sys(&s){}
 
 	virtual void probe(void)
 	{
@@ -22,6 +22,7 @@ namespace MODEL {
   // Uniform
   //------------------------------------------------------------
 
+	const number Uniform::AM=1.0/IM;
 	const number Uniform::RNMX=1.0-EPS;
 
 
@@ -80,7 +80,7 @@ namespace MODEL
 
 	static const counter IA=16807;
 	static const counter IM=2147483647;
-	static const number AM=1.0/IM;
+	static const number AM;
 	static const counter IQ=127773;
 	static const counter IR=2836;
 	static const counter tabelsize=32;
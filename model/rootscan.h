@@ -32,11 +32,32 @@
 #include "eigenvalues.h"
 #include "newtonroot.h"
 #include "jacobian.h"
+#include "modelinstance.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <exception>
 
 namespace MODEL 
 {
-  /** A class to store a parameter scan. Very ad hoc fro the moment
-	  and not flexible at all 
+  /** A class to store a parameter scan: a number of vectors (a
+	  parpoint) for every parameter value, any number of parpoints per
+	  value. In practice the vectors are a root and the real and
+	  imaginary parts of its eigenvalues.
+
+	  The storage is one block of parameters and one block of vectors,
+	  parpoint after parpoint, shared between copies: adding a point
+	  costs no allocation of its own, and a copy or a select() costs
+	  only a list of row numbers. A copy that gets written to takes a
+	  private copy of the data first. The parpoints are kept in
+	  parameter order (and in the order they were added for the same
+	  parameter) by an index next to the data.
+
+	  That index is sorted lazily, by the const accessors: using one
+	  ScanList from several threads at once is not safe, even when
+	  they only read. Give every thread its own copy (that is cheap),
+	  made before the threads start.
   */
   template<integer dims, typename nelem=number, class NT =
   NumericTraits<nelem,dims> >
@@ -62,50 +83,99 @@ namespace MODEL
 	/** a function which returns true when the point is "good" */
 	typedef bool criteria(const parpoint&);
 
-	/** Clear out everything
-		\todo check if this doe not leak
-	*/
-	void clear() {dat.clear();}
+	ScanList() : col(new Columns), ordered(true), view(false) {}
+
+	/** Clear out everything */
+	void clear() {col.reset(new Columns); order.clear(); ordered=true; view=false;}
+
+	/** The number of parpoints */
+	counter size(void) const {return (view)?order.size():col->param.size();}
 
-	/** Find the closest solutions */
+	/** The parameter of the i-th parpoint, in parameter order */
+	const number& get_param(counter i) const {return col->param[row(i)];}
+
+	/** The number of vectors in the i-th parpoint */
+	counter get_width(counter i) const
+	{
+	  const counter r=row(i);
+	  return col->start[r+1]-col->start[r];
+	}
+
+	/** Vector k of the i-th parpoint */
+	const NumVector<dims,nelem,NT>& get_vector(counter i, counter k) const
+	{
+	  return col->vecs[col->start[row(i)]+k];
+	}
+
+	/** The i-th parpoint as a whole */
+	parpoint get_parpoint(counter i) const
+	{
+	  parpoint pp;
+	  fill(pp,row(i));
+	  return pp;
+	}
+
+	/** The first parpoint at exactly this parameter value, or size()
+		if there is none */
+	counter find(const number& param) const
+	{
+	  const counter i=lower(param);
+	  return (i<size() && get_param(i)==param)?i:size();
+	}
+
+	/** The number of parpoints at exactly this parameter value */
+	counter count(const number& param) const
+	{
+	  counter i=lower(param),n=0;
+	  while (i<size() && get_param(i)==param) {++i; ++n;}
+	  return n;
+	}
+
+	/** Find the closest solutions: all parpoints at the first
+		parameter value above param */
 	parpointlist get_solution(number param)
 	{
-	  typename datalist::iterator here=dat.upper_bound(param);
-	  return here->second;
+	  parpointlist found;
+	  counter i=lower(param);
+	  while (i<size() && get_param(i)==param) ++i;
+	  if (i==size()) return found;
+	  const number here=get_param(i);
+	  for (;i<size() && get_param(i)==here;++i) found.push_back(get_parpoint(i));
+	  return found;
 	}
 
 	/** Add a point to the newest parpoint*/
 	void add_point(const vect& v)
 	{
-	  p.push_back(v);
+	  own();
+	  col->vecs.push_back(v);
 	}
 
 	/** Finalize: add the parpoint to the parpointlist for a certain
 		parameter, and clear it*/
 	void add_param(const number& param)
 	{
-	  dat[param].push_back(p);
-	  p.clear();
+	  own();
+	  col->param.push_back(param);
+	  col->start.push_back(col->vecs.size());
+	  ordered=false;
 	}
 	
-	/** select a part of the list, the rest is discarded. Returns the
-		new list. Note: no use is made of remove_if from the STL,
-		which would be the better way to go. Time... */
+	/** select a part of the list. Returns the new list, which shares
+		the data with this one: only the row numbers of the good
+		parpoints are copied. */
 	ScanList select(criteria ifthis) const
 	{
-	  // make a copy
 	  ScanList selected(*this);
-
-	  // Run thru it, removing all bad elements
-	  for(typename datalist::iterator p=selected.dat.begin();
-		  p!=selected.dat.end();++p)
+	  selected.order.clear();
+	  parpoint pp;
+	  for (counter i=0;i<size();i++)
 		{
-		  typename parpointlist::iterator pp=p->second.begin();
-		  while(pp!=p->second.end())
-			if(!ifthis(*pp)) pp=p->second.erase(pp);
-			else ++pp;
+		  fill(pp,row(i));
+		  if (ifthis(pp)) selected.order.push_back(row(i));
 		}
-	  
+	  selected.ordered=true;
+	  selected.view=true;
 	  return selected;
 	}
 
@@ -116,48 +186,35 @@ namespace MODEL
 	{
 	  out << "# Raw data -----------------------" << endl;
 	  
-	  for(typename datalist::iterator parr=dat.begin();
-		  parr!=dat.end();
-		  ++parr)
+	  for (counter i=0;i<size();i++)
 		{
-
-		  for(typename parpointlist::iterator pointlist=parr->second.begin();
-			  pointlist!=parr->second.end();
-			  ++pointlist)
-			{
-			  out << parr->first; // Write parameter value
-			  for(typename parpoint::iterator point=pointlist->begin();
-				  point!=pointlist->end();
-				  ++point)
-				out << "\t" << *point;
-			  out << endl;
-			}
+		  out << get_param(i); // Write parameter value
+		  for (counter k=0;k<get_width(i);k++)
+			out << "\t" << get_vector(i,k);
+		  out << endl;
 		}
 	}
 
 	/** Add two lists together. Good to generate plots for a certain
 		parameter, varying another */
-	ScanList operator+=(const ScanList<dims,nelem>& extra)
+	ScanList& operator+=(const ScanList& extra)
 	{
-	  const datalist& other=extra.dat;
-	  
-	  for(typename datalist::const_iterator parr=other.begin();
-		  parr!=other.end();
-		  ++parr)
+	  own();
+	  // extra may be this list itself
+	  const counter n=extra.size();
+	  const counter r0=col->param.size();
+	  col->param.reserve(r0+n);
+	  col->start.reserve(r0+n+1);
+	  for (counter i=0;i<n;i++)
 		{
-
-		  for(typename parpointlist::const_iterator pointlist=parr->second.begin();
-			  pointlist!=parr->second.end();
-			  ++pointlist)
-			{
-			  // out << parr->first; // Write parameter value
-			  for(typename parpoint::const_iterator point=pointlist->begin();
-				  point!=pointlist->end();
-				  ++point)
-				add_point(*point); // out << "\t" << *point;
-			  add_param(parr->first); // out << endl;
-			}
+		  const Columns& from=*extra.col;
+		  const counter r=extra.row(i);
+		  for (counter k=from.start[r];k<from.start[r+1];k++)
+			col->vecs.push_back(from.vecs[k]);
+		  col->param.push_back(from.param[r]);
+		  col->start.push_back(col->vecs.size());
 		}
+	  ordered=false;
 	  return *this;
 	}
 	
@@ -168,41 +225,41 @@ namespace MODEL
 		you by a factor of how much the roots and eigenvalues have to
 		match
 		\note FIXED: printlist eats all the data, and nothing is left 
-		afterwards. So: we have to make a copy first 
+		afterwards. So: we have to make a copy first. Now it just
+		marks the parpoints it has written.
 		\bug We should look for the closest match !!!
 	*/ 
 	void print_list(ostream& out, const number& accuracy=1.)
 	{
-	  datalist toprint(dat);
-	  
+	  const counter n=size();
+	  vector<bool> used(n,false);
+
 	  out << "# Scanlist output --------------------" << endl;
 	  
 	  counter pieces(0);
   
 	  // 1) Find a starting parameter value
   
-	  typename datalist::iterator parrunner(toprint.begin());
-	  while(parrunner!=toprint.end()) { // while there are parameters left
+	  counter parrunner(0);
+	  while(parrunner<n) { // while there are parameters left
+		const counter parend=next_param(parrunner);
 
 		// 2) Find a starting point
-		typename parpointlist::iterator varrunner(parrunner->second.begin());
+		counter varrunner=first_unused(used,parrunner,parend);
 		
-		while (varrunner!=parrunner->second.end()) { // if there are any
-		  typename datalist::iterator nextrunner(parrunner);
-		  number param=nextrunner->first; // get first = KEY 
+		while (varrunner<parend) { // if there are any
+		  number param=get_param(parrunner); // get first = KEY 
 
 		  // write comment
 		  out << "# -------------------------------" 
 			  << " Start of list starting at " << param <<endl;
 
 		  // We have a starting point, remove it from the list
-		  parpoint previous(*varrunner);
+		  parpoint previous(get_parpoint(varrunner));
 		  number previousparam(param);
 
-		  typename parpointlist::iterator diepiggy(varrunner);
-		  
-		  parrunner->second.erase(diepiggy); // first erase,
-		  varrunner=parrunner->second.begin(); // then find another
+		  used[varrunner]=true; // first erase,
+		  varrunner=first_unused(used,parrunner,parend); // then find another
 	  
 		  // Add it to our list:		  
 		  out << param;
@@ -212,33 +269,30 @@ namespace MODEL
 		  out << endl;
 	  
 		  // Find a next point (a higher par value)
-		  ++nextrunner;
-		  while (nextrunner!=toprint.end()){  // loopy - we have points
-			// find someone to love
-			bool loved=false;
-			number nextparam=nextrunner->first;
-
-			typename parpointlist::iterator inrunner=nextrunner->second.begin();
+		  counter nextrunner=parend;
+		  while (nextrunner<n){  // loopy - we have points
+			const counter nextend=next_param(nextrunner);
+			number nextparam=get_param(nextrunner);
 
 			// calculate match requirements
 			number maxchange=accuracy*nextparam/previousparam;
 
-			while (inrunner!=nextrunner->second.end()) { // find match
+			for (counter inrunner=nextrunner;inrunner<nextend;inrunner++) { // find match
+			  if (used[inrunner]) continue;
 
 			  // Ok, we have one
 			  parpoint match(previous);
-			  parpoint gotcha(*inrunner);
 			  bool matched=true;
 			  
 			  // Is it any good: calculate all differences
+			  counter j=0;
 			  for(typename parpoint::iterator 
 					i=match.begin(), 
-					j=gotcha.begin(),
 					k=previous.begin();
 				  i!=match.end();
 				  ++i,++j,++k)
 				{
-				  *i -= *j;
+				  *i -= get_vector(inrunner,j);
 				  *i /=length(*k); // normalized difference
 
 				  // the abs is to make sure it works for complex
@@ -251,10 +305,11 @@ namespace MODEL
 			  /** \todo  actually, we should search the best match, but for
 				  now, this should be sufficient */
 			  if(matched) { // we have a match
-				previous=gotcha;
+				previous=get_parpoint(inrunner);
 			
 				// Remove it from the list
-				parrunner->second.erase(inrunner);
+				used[inrunner]=true;
+				if (inrunner==varrunner) varrunner=first_unused(used,parrunner,parend);
 			
 				// Add it to our list:
 				out << nextparam;
@@ -263,24 +318,13 @@ namespace MODEL
 				  out << "\t" << *i;
 				out << endl;
 
-				loved=true;
 				break; // We are happy, go to next parval		
 			  }
-			  else ++inrunner;
 		  
-			} // while find match
+			} // find match
 
-			if(loved) {
-			  // try it with the next parval
-			  ++nextrunner;
-			}
-			else {
-			  // All exhausted, close our list
-			  // cout << "#----------------------------" << endl;
-			  ++nextrunner;
-		  
-			  // break;		  
-			}
+			// try it with the next parval
+			nextrunner=nextend;
 
 			previousparam=nextparam;
 		
@@ -296,20 +340,131 @@ namespace MODEL
 	
 	
 		// Go to next parameter value, as we are exhausted here
-		++parrunner;
+		parrunner=parend;
 	
 	  } // while parameters left  
 	  out << "# Number of distict pieces: " << pieces << endl;
 	}
 	  
-	datalist& get_data(void)
+	/** The whole list in the old layout: a map from the parameter to
+		the parpoints. This is a copy, made when you ask for it, and
+		const, since changing it would not change the list.
+		\deprecated use size(), find(), count(), get_param() and
+		get_vector() instead */
+	const datalist get_data(void) const
 	{
+	  datalist dat;
+	  for (counter i=0;i<size();i++) dat[get_param(i)].push_back(get_parpoint(i));
 	  return dat;
 	}
 
   private:
-	datalist dat;
-	parpoint p;
+	/** The data: parameters, and all the vectors in one block. The
+		vectors of row r are vecs[start[r]] up to vecs[start[r+1]];
+		vectors after the last start belong to the parpoint being built */
+	struct Columns
+	{
+	  Columns() : start(1,0) {}
+	  vector<number>	param;
+	  vector<counter>	start;
+	  vector< NumVector<dims,nelem,NT> >	vecs;
+	};
+
+	/** The row of the i-th parpoint in parameter order */
+	counter row(counter i) const
+	{
+	  if (!ordered) sort();
+	  return (view)?order[i]:((order.empty())?i:order[i]);
+	}
+
+	/** Rebuild the index: rows sorted on parameter, rows with the same
+		parameter in the order they were added */
+	void sort(void) const
+	{
+	  const counter n=col->param.size();
+	  order.resize(n);
+	  bool already=true;
+	  for (counter r=0;r<n;r++)
+		{
+		  order[r]=r;
+		  if (r>0 && col->param[r]<col->param[r-1]) already=false;
+		}
+	  if (already) order.clear();  // the rows are in order already
+	  else std::stable_sort(order.begin(),order.end(),ByParam(col->param));
+	  ordered=true;
+	}
+
+	struct ByParam
+	{
+	  ByParam(const vector<number>& p) : par(p) {}
+	  bool operator()(counter a, counter b) const {return par[a]<par[b];}
+	  const vector<number>& par;
+	};
+
+	/** First i with get_param(i) >= param */
+	counter lower(const number& param) const
+	{
+	  counter lo=0,hi=size();
+	  while (lo<hi)
+		{
+		  const counter mid=(lo+hi)/2;
+		  if (get_param(mid)<param) lo=mid+1; else hi=mid;
+		}
+	  return lo;
+	}
+
+	/** First i after i0 with another parameter */
+	counter next_param(counter i0) const
+	{
+	  counter i=i0+1;
+	  while (i<size() && get_param(i)==get_param(i0)) ++i;
+	  return i;
+	}
+
+	static counter first_unused(const vector<bool>& used, counter from, counter to)
+	{
+	  while (from<to && used[from]) ++from;
+	  return from;
+	}
+
+	void fill(parpoint& pp, counter r) const
+	{
+	  pp.assign(col->vecs.begin()+col->start[r],col->vecs.begin()+col->start[r+1]);
+	}
+
+	/** Make the data ours alone before writing to it: a selection or
+		a copy gets the rows it sees (in order) and the parpoint being
+		built */
+	void own(void)
+	{
+	  if (!view && col.use_count()==1) return;
+	  std::shared_ptr<Columns> mine(new Columns);
+	  const counter n=size();
+	  mine->param.reserve(n);
+	  mine->start.reserve(n+1);
+	  for (counter i=0;i<n;i++)
+		{
+		  const counter r=row(i);
+		  for (counter k=col->start[r];k<col->start[r+1];k++)
+			mine->vecs.push_back(col->vecs[k]);
+		  mine->param.push_back(col->param[r]);
+		  mine->start.push_back(mine->vecs.size());
+		}
+	  for (counter k=col->start.back();k<(counter)col->vecs.size();k++)
+		mine->vecs.push_back(col->vecs[k]);
+	  col=mine;
+	  order.clear();
+	  ordered=true;
+	  view=false;
+	}
+
+	std::shared_ptr<Columns>	col;
+	/** The index: rows in parameter order (empty when they already
+		are), or the rows of a selection */
+	mutable vector<counter>	order;
+	mutable bool	ordered;
+	/** Is this a selection of the rows in col? */
+	bool	view;
   };
  
   //------------------------------------------------------------
@@ -329,8 +484,14 @@ namespace MODEL
 	typedef typename NT::vf vf;
 	typedef typename NT::vect vect;
 
-	/** Initialize */
-	RootScan(vf& tobescanned, const string& param, vect starter=1.) : f(&tobescanned)
+	/** Initialize. With own, the scan works on a ModelInstance of
+		its own, and leaves the parameter of tobescanned alone: then
+		other scans (or a simulation) can use the same function at the
+		same time. */
+	RootScan(vf& tobescanned, const string& param, vect starter=1., bool own=false) :
+	  mine((own)?new ModelInstance<dims,nelem,NT>(tobescanned):NULL),
+	  f((own)?&mine->get_function():&tobescanned),
+	  parname(param), threads(1), stability(true)
 	{
 	  Parameter p=f->get_parameter(param);
 	  _p=&p;
@@ -343,18 +504,22 @@ namespace MODEL
   /** Added as a convenience: we want to find only the roots of the
 	  system at the point it is right now: the parameter has been
 	  set by other means */
-  RootScan(vf& tobescanned) : f(&tobescanned)
+  RootScan(vf& tobescanned) : mine(NULL), f(&tobescanned), threads(1), stability(true)
   {
 	_p=&dummy;
   }
 
+  ~RootScan() {delete mine;}
+
   /** Add other possible starting points */
   void add_start(const vect start)
   {
 	def_starters.push_back(start);
   }
 
-  /** Scan */
+  /** Scan n parameter values from "from" to "to". Every root found
+	  at one value is a starting point at the next one, on top of the
+	  default starters. See set_threads() for a parallel scan. */
   const ScanList<dims,nelem,NT>& scan(const number& from, 
 									  const number& to,
 									  const counter& n)
@@ -364,18 +529,105 @@ namespace MODEL
 
 	number delta=(to-from)/number(n-1);
 
+	// The parameter values, exactly as the loop over *_p produces
+	// them, and the value the loop leaves behind
+	vector<number> values;
+	number last;
+	for(last=from;last<=to;last+=delta) values.push_back(last);
+
+	const counter chunks=(threads<(counter)values.size())?threads:values.size();
+	if(chunks<=1 || parname.empty())
+	  scan_range(*f,_p,values,0,values.size(),def_starters,stability,roots);
+	else
+	  scan_parallel(values,chunks);
+
+	*_p=last;
+	return roots;
+  }
+
+  /** Use n threads for scan(). The parameter range is cut into n
+	  pieces of consecutive values; every piece is scanned by its own
+	  thread on its own clone of the function, starting from the
+	  default starters only, and the results are put together in order.
+	  So the ScanList is the same from run to run, but at the start of
+	  a piece the roots of the previous value are not used as starting
+	  points: add enough starters with add_start(). 
+
+	  The clones need their parameters: the copy constructor of your
+	  function has to call define_parameter() again. The default is 1,
+	  an ordinary serial scan.
+  */
+  void set_threads(counter n)
+  {
+	threads=(n>0)?n:1;
+  }
+
+  /** With false, scan() only looks for the roots: every parpoint is
+	  just the root, without the eigenvalues, which saves a jacobian
+	  and a decomposition per root. The criteria below that look at
+	  stability can't be used on such a list. */
+  void set_stability(bool calc=true)
+  {
+	stability=calc;
+  }
+
+  // A few examples of criteria
+  /** select all */
+  static bool all(const typename ScanList<dims,nelem,NT>::parpoint& p) {return true;}
+  /** select stable ones - this assumes the real parts of the
+	  eigenvalues are the second element of the parpoint and that we
+	  are working in a 3d system.*/
+  static bool stable(const typename ScanList<dims,nelem,NT>::parpoint& p) 
+  {
+	bool stab=true;
+	for(counter i=0;i<dims;++i) stab=stab&&(p[1][i]<0);
+	  
+	return stab;
+  }
+  /** select unstable ones - see note for stable */
+  static bool unstable(const typename ScanList<dims,nelem,NT>::parpoint& p)
+  {
+	return !stable(p);
+  }
+  /** select positive ones - this assumes that the function is the
+	  first element of the parpoint*/
+  static bool positive(const  typename ScanList<dims,nelem,NT>::parpoint &p)
+  {
+	bool pos=true;
+	for(counter i=0;i<dims;++i) pos=pos&&(p[0][i]>-1E-4);
+	// Agree, this is still negative, but still... Just to remove
+	// rounding errors which play hell on the routines
+	  
+	return pos;
+  }
+
+  static bool negative(const  typename ScanList<dims,nelem,NT>::parpoint &p)
+  {
+	return !positive(p);
+  }
+
+	
+private:
+  /** Scan values[first..last) for func, with par the parameter inside
+	  func, and put the roots in out. This is the scan proper. */
+  static void scan_range(vf& func, number* par, 
+						 const vector<number>& values, counter first, counter last,
+						 const list< NumVector<dims,nelem,NT> >& def_starters,
+						 bool stability, ScanList<dims,nelem,NT>& out)
+  {
 	// A starting value list
 	list< NumVector<dims,nelem,NT> > starters(def_starters);
 
-	for(*_p=from;*_p<=to;*_p+=delta)		{
+	for(counter v=first;v<last;v++)		{
+	  *par=values[v];
 #ifdef ROOTSCAN_DEBUG
-	  cerr << "PARAMETER SCAN: " << *_p << endl;
+	  cerr << "PARAMETER SCAN: " << *par << endl;
 #endif
 	  // Add a bumpy layer, to find other zeroes
-	  VFwithBump<dims,nelem,NT>	bumpy(*f);
+	  VFwithBump<dims,nelem,NT>	bumpy(func);
 	  // Find stationary solution (the zeroes)
 	  NewtonRoot<dims,nelem,NT> stat(bumpy);
-	  Jacobian<dims> J(*f,1E-6);
+	  Jacobian<dims,NT> J(func,Precision<typename NT::number>::sqrt_tolerance(1E-6));
 
 	  NumVector<dims,nelem,NT> solution;
 
@@ -404,26 +656,28 @@ namespace MODEL
 				break;}
 				
 		  //debug : 
-		  // cerr << *_p << ":\t" << solution << endl;
+		  // cerr << *par << ":\t" << solution << endl;
 			  
 		  if(stat.wrong_min()) {++start; break;}
 		  if(stat.no_root()) {++start; break;}
 
 		  // Oh goody, a root !
 			  
-		  // Find stability
-		  NumVector<dims,nelem,NT> reals=Eigenvalues<dims,nelem,NT>(J.calculate(solution)).real();
-		  NumVector<dims,nelem,NT> imags=Eigenvalues<dims,nelem,NT>(J.calculate(solution)).imag();
-			
 		  // Define the data
 #ifdef ROOTSCAN_DEBUG
 		  cerr << "STATPOINT:" << solution << endl;
 #endif
-		  roots.add_point(solution);
-		  roots.add_point(reals);
-		  roots.add_point(imags);
+		  out.add_point(solution);
+
+		  // Find stability: one jacobian, one decomposition
+		  if(stability)
+			{
+			  Eigenvalues<dims,nelem,NT> ev(J.calculate(solution));
+			  out.add_point(ev.real());
+			  out.add_point(ev.imag());
+			}
 		  // Save the data
-		  roots.add_param(*_p);
+		  out.add_param(*par);
 
 		  // add the solution to the bumplist
 		  bumpy.AddBump(solution);
@@ -440,9 +694,9 @@ namespace MODEL
 		  //  				{
 		  //  				  NumVector<dims,nelem,NT> nsplus(solution);
 		  //  				  NumVector<dims,nelem,NT> nsmin(solution);
-		  // 				  nsplus[i]+= (delta / *_p)*solution[i]; // Linear
+		  // 				  nsplus[i]+= (delta / *par)*solution[i]; // Linear
 		  // 				  // Interpol
-		  // 				  nsmin[i]-= (delta / *_p)*solution[i]; // Linear Interpol 
+		  // 				  nsmin[i]-= (delta / *par)*solution[i]; // Linear Interpol 
 		  // 				  starters.push_back(nsplus);
 		  // 				  starters.push_back(nsmin);
 
@@ -452,48 +706,81 @@ namespace MODEL
 			
 	  }
 	}
-	return roots;
   }
-	
-  // A few examples of criteria
-  /** select all */
-  static bool all(const typename ScanList<dims,nelem,NT>::parpoint& p) {return true;}
-  /** select stable ones - this assumes the real parts of the
-	  eigenvalues are the second element of the parpoint and that we
-	  are working in a 3d system.*/
-  static bool stable(const typename ScanList<dims,nelem,NT>::parpoint& p) 
-  {
-	bool stab=true;
-	for(counter i=0;i<dims;++i) stab=stab&&(p[1][i]<0);
-	  
-	return stab;
-  }
-  /** select unstable ones - see note for stable */
-  static bool unstable(const typename ScanList<dims,nelem,NT>::parpoint& p)
+
+  /** One thread of a parallel scan */
+  struct Piece
   {
-	return !stable(p);
-  }
-  /** select positive ones - this assumes that the function is the
-	  first element of the parpoint*/
-  static bool positive(const  typename ScanList<dims,nelem,NT>::parpoint &p)
+	ModelInstance<dims,nelem,NT>*	model;
+	number*	par;
+	counter	first,last;
+	bool	stability;
+	ScanList<dims,nelem,NT>	found;
+	std::exception_ptr		error;
+  };
+
+  static void scan_piece(Piece* p, const vector<number>* values,
+						 const list< NumVector<dims,nelem,NT> >* def_starters)
   {
-	bool pos=true;
-	for(counter i=0;i<dims;++i) pos=pos&&(p[0][i]>-1E-4);
-	// Agree, this is still negative, but still... Just to remove
-	// rounding errors which play hell on the routines
-	  
-	return pos;
+	try
+	  {
+		scan_range(p->model->get_function(),p->par,*values,
+				   p->first,p->last,*def_starters,p->stability,p->found);
+	  }
+	catch (...)
+	  {
+		p->error=std::current_exception();
+	  }
   }
 
-  static bool negative(const  typename ScanList<dims,nelem,NT>::parpoint &p)
+  void scan_parallel(const vector<number>& values, counter chunks)
   {
-	return !positive(p);
+	const ParameterHandle h=f->get_handle(parname);
+	const counter size=values.size();
+	vector<Piece> pieces(chunks);
+	for(counter c=0;c<chunks;c++) pieces[c].model=NULL;
+	try
+	  {
+		for(counter c=0;c<chunks;c++)
+		  {
+			pieces[c].model=new ModelInstance<dims,nelem,NT>(*f);
+			pieces[c].par=&pieces[c].model->get_parameter(h);
+			pieces[c].first=(size*c)/chunks;
+			pieces[c].last=(size*(c+1))/chunks;
+			pieces[c].stability=stability;
+		  }
+	  }
+	catch (...)
+	  {
+		for(counter c=0;c<chunks;c++) delete pieces[c].model;
+		throw;
+	  }
+
+	vector<std::thread> workers;
+	for(counter c=0;c<chunks;c++)
+	  workers.push_back(std::thread(scan_piece,&pieces[c],&values,&def_starters));
+	for(counter c=0;c<chunks;c++) workers[c].join();
+
+	std::exception_ptr error;
+	for(counter c=0;c<chunks;c++)
+	  {
+		delete pieces[c].model;
+		if(pieces[c].error && !error) error=pieces[c].error;
+		roots+=pieces[c].found;
+	  }
+	if(error) std::rethrow_exception(error);
   }
 
-	
-private:
+  /** Our own copy of the function, if we have one */
+  ModelInstance<dims,nelem,NT>* mine;
   vf* f;
   number* _p;
+  /** The name of the scanned parameter, to find it in a clone */
+  string parname;
+  /** The number of threads for scan() */
+  counter threads;
+  /** Calculate the eigenvalues? */
+  bool stability;
   ScanList<dims,nelem,NT> roots;
 
   // if we don't have a parameter to scan
@@ -502,6 +789,9 @@ private:
 public:
   /** A list of starting points to use */
   list< NumVector<dims,nelem,NT> > def_starters;
+
+  /** Don't copy or assign */
+  NO_COPY(RootScan);
 };
   
 
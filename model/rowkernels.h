@@ -0,0 +1,97 @@
+/***************************************************************************
+                          rowkernels.h  -  inner loops on matrix rows
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef ROWKERNELS_H
+#define ROWKERNELS_H
+
+#include "numerictypes.h"
+
+/** Hand written AVX2 versions of the kernel for double and float.
+	Define MODEL_USE_AVX2 (configure --enable-avx2) and compile with
+	-mavx2 to get them; without the instruction set the plain loops
+	are used. They do exactly the same operations in the same order (a
+	multiply and a subtract per element, never fused), so the results
+	are the same bit for bit as long as the compiler does not fuse the
+	plain loops either (-ffp-contract=off, which --enable-avx2 sets). */
+#if defined(MODEL_USE_AVX2) && defined(__AVX2__)
+#define MODEL_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace MODEL {
+
+  /** The inner loop of the O(n^3) matrix routines, working on
+	  contiguous rows (a NumVector row is one block of memory, see
+	  numstorage.h). The generic version is plain C++ the compiler
+	  may vectorise on its own; there are specialisations below.
+	  LUSolve only goes row-oriented when simd is set.
+  */
+  template <typename numT>
+  struct RowKernel
+  {
+	/** Is there a hand written SIMD version? */
+	static const bool	simd=false;
+
+	/** y[j] -= l*x[j] for j in [0,n) */
+	static void	update(numT* y, const numT* x, const numT& l, integer n)
+	{
+	  for (integer j=0;j<n;j++) y[j] -= l*x[j];
+	}
+  };
+
+#ifdef MODEL_AVX2_KERNELS
+
+  template <>
+  struct RowKernel<double>
+  {
+	static const bool	simd=true;
+
+	static void	update(double* y, const double* x, const double& l, integer n)
+	{
+	  const __m256d	ll=_mm256_set1_pd(l);
+	  integer j=0;
+	  for (;j+4<=n;j+=4)
+		{
+		  __m256d r=_mm256_sub_pd(_mm256_loadu_pd(y+j),_mm256_mul_pd(ll,_mm256_loadu_pd(x+j)));
+		  _mm256_storeu_pd(y+j,r);
+		}
+	  for (;j<n;j++) y[j] -= l*x[j];
+	}
+  };
+
+  template <>
+  struct RowKernel<float>
+  {
+	static const bool	simd=true;
+
+	static void	update(float* y, const float* x, const float& l, integer n)
+	{
+	  const __m256	ll=_mm256_set1_ps(l);
+	  integer j=0;
+	  for (;j+8<=n;j+=8)
+		{
+		  __m256 r=_mm256_sub_ps(_mm256_loadu_ps(y+j),_mm256_mul_ps(ll,_mm256_loadu_ps(x+j)));
+		  _mm256_storeu_ps(y+j,r);
+		}
+	  for (;j<n;j++) y[j] -= l*x[j];
+	}
+  };
+
+#endif // MODEL_AVX2_KERNELS
+
+} // end namespace MODEL
+#endif
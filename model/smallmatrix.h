@@ -0,0 +1,253 @@
+/***************************************************************************
+                          smallmatrix.h  -  closed forms for 2x2 and 3x3
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SMALLMATRIX_H
+#define SMALLMATRIX_H
+
+#include "numerictypes.h"
+#include "numerictraits.h"
+#include <cmath>
+
+namespace MODEL {
+
+  /** Closed forms for small matrices. Most models have two or three
+	  variables, and for those pivoting LU, balancing and Hessenberg QR
+	  are a lot of work to get a handful of numbers. LUSolve,
+	  Eigenvalues and Invariant ask this class first and only run
+	  their general algorithm when it returns false.
+
+	  The general version does nothing: there are specialisations for
+	  dims 2 and 3 below. All the sizes are known at compile time, so
+	  the compiler throws away whichever branch is not used.
+  */
+  template <integer dims, class NT = NumericTraits<number,dims> >
+  struct SmallMatrix
+  {
+	typedef typename NT::number	numT;
+	typedef	typename NT::vect 	vect;
+	typedef typename NT::matrix matrix;
+
+	/** Is there a closed form for this size? */
+	static const bool	closed=false;
+
+	/** Replace m by its inverse and return the determinant in d.
+		Returns false (and leaves m alone) if it can't: then you need
+		LU with pivoting. */
+	static bool	invert(matrix&, numT&) {return false;}
+
+	/** u = m.u, for the inverse computed by invert() */
+	static void	apply(const matrix&, vect&) {}
+
+	/** The i-th invariant (0 = trace, dims-1 = determinant) */
+	static numT	invariant(const matrix&, integer) {return numT(0.);}
+
+	/** Eigenvalues into wr and wi */
+	static bool	eigenvalues(const matrix&, vect&, vect&) {return false;}
+  };
+
+  template <class NT>
+  struct SmallMatrix<2,NT>
+  {
+	typedef typename NT::number	numT;
+	typedef	typename NT::vect 	vect;
+	typedef typename NT::matrix matrix;
+
+	static const bool	closed=true;
+
+	static numT	det(const matrix& m)
+	{
+	  return m[0][0]*m[1][1]-m[0][1]*m[1][0];
+	}
+
+	static bool	invert(matrix& m, numT& d)
+	{
+	  d=det(m);
+	  if (d == 0.0) return false;
+	  const numT	r=numT(1.)/d;
+	  const numT	a=m[0][0];
+	  m[0][0]=r*m[1][1];
+	  m[1][1]=r*a;
+	  m[0][1]*=-r;
+	  m[1][0]*=-r;
+	  return true;
+	}
+
+	static void	apply(const matrix& m, vect& u)
+	{
+	  const numT	u0=u[0];
+	  u[0]=m[0][0]*u0+m[0][1]*u[1];
+	  u[1]=m[1][0]*u0+m[1][1]*u[1];
+	}
+
+	static numT	invariant(const matrix& m, integer i)
+	{
+	  return (i==0)?(m[0][0]+m[1][1]):det(m);
+	}
+
+	/** The same formula hqr uses for its last 2x2 block, written so
+		that nothing cancels */
+	static bool	eigenvalues(const matrix& m, vect& wr, vect& wi)
+	{
+	  const numT	x=m[1][1];
+	  const numT	w=m[0][1]*m[1][0];
+	  const numT	p=numT(0.5)*(m[0][0]-x);
+	  const numT	q=p*p+w;
+	  const numT	z=std::sqrt(std::abs(q));
+	  if (q >= 0.0)
+		{
+		  const numT s=p+((p>=0.)?z:-z);
+		  wr[0]=wr[1]=x+s;
+		  if (s != 0.0) wr[1]=x-w/s;
+		  wi[0]=wi[1]=0.;
+		}
+	  else
+		{
+		  wr[0]=wr[1]=x+p;
+		  wi[0]=-z;
+		  wi[1]=z;
+		}
+	  return true;
+	}
+  };
+
+  template <class NT>
+  struct SmallMatrix<3,NT>
+  {
+	typedef typename NT::number	numT;
+	typedef	typename NT::vect 	vect;
+	typedef typename NT::matrix matrix;
+
+	static const bool	closed=true;
+
+	static numT	det(const matrix& m)
+	{
+	  return m[0][0]*(m[1][1]*m[2][2]-m[1][2]*m[2][1])
+		-m[0][1]*(m[1][0]*m[2][2]-m[1][2]*m[2][0])
+		+m[0][2]*(m[1][0]*m[2][1]-m[1][1]*m[2][0]);
+	}
+
+	/** Adjugate over determinant */
+	static bool	invert(matrix& m, numT& d)
+	{
+	  const numT c00=m[1][1]*m[2][2]-m[1][2]*m[2][1];
+	  const numT c01=m[1][2]*m[2][0]-m[1][0]*m[2][2];
+	  const numT c02=m[1][0]*m[2][1]-m[1][1]*m[2][0];
+	  d=m[0][0]*c00+m[0][1]*c01+m[0][2]*c02;
+	  if (d == 0.0) return false;
+	  const numT	r=numT(1.)/d;
+	  const numT i01=r*(m[0][2]*m[2][1]-m[0][1]*m[2][2]);
+	  const numT i02=r*(m[0][1]*m[1][2]-m[0][2]*m[1][1]);
+	  const numT i11=r*(m[0][0]*m[2][2]-m[0][2]*m[2][0]);
+	  const numT i12=r*(m[0][2]*m[1][0]-m[0][0]*m[1][2]);
+	  const numT i21=r*(m[0][1]*m[2][0]-m[0][0]*m[2][1]);
+	  const numT i22=r*(m[0][0]*m[1][1]-m[0][1]*m[1][0]);
+	  m[0][0]=r*c00; m[0][1]=i01; m[0][2]=i02;
+	  m[1][0]=r*c01; m[1][1]=i11; m[1][2]=i12;
+	  m[2][0]=r*c02; m[2][1]=i21; m[2][2]=i22;
+	  return true;
+	}
+
+	static void	apply(const matrix& m, vect& u)
+	{
+	  const numT	u0=u[0],u1=u[1],u2=u[2];
+	  u[0]=m[0][0]*u0+m[0][1]*u1+m[0][2]*u2;
+	  u[1]=m[1][0]*u0+m[1][1]*u1+m[1][2]*u2;
+	  u[2]=m[2][0]*u0+m[2][1]*u1+m[2][2]*u2;
+	}
+
+	/** Sum of the principal 2x2 minors */
+	static numT	minors(const matrix& m)
+	{
+	  return (m[0][0]*m[1][1]-m[0][1]*m[1][0])
+		+(m[0][0]*m[2][2]-m[0][2]*m[2][0])
+		+(m[1][1]*m[2][2]-m[1][2]*m[2][1]);
+	}
+
+	static numT	invariant(const matrix& m, integer i)
+	{
+	  switch (i)
+		{
+		case 0: return m[0][0]+m[1][1]+m[2][2];
+		case 1: return minors(m);
+		default: return det(m);
+		}
+	}
+
+	/** Roots of l^3 - a l^2 + b l - c, with a, b and c the
+		invariants. Cardano when there is one real root, the
+		trigonometric form when there are three; every real root gets
+		one Newton step on the cubic to polish it. The real part of a
+		complex pair comes from the trace and the polished real root.
+		When it is too close to zero to trust its sign (near a Hopf
+		point, where the stability depends on it) this returns false,
+		and Eigenvalues uses hqr instead. */
+	static bool	eigenvalues(const matrix& m, vect& wr, vect& wi)
+	{
+	  const numT	a=invariant(m,0),b=minors(m),c=det(m);
+	  // l = x + a/3 gives x^3 + P x + Q
+	  const numT	s=a/numT(3.);
+	  const numT	P=b-a*s;
+	  const numT	Q=s*(b-numT(2.)*s*s)-c;
+	  const numT	D=numT(0.25)*Q*Q+P*P*P/numT(27.);
+
+	  wi[0]=wi[1]=wi[2]=0.;
+	  if (D > 0.0)
+		{
+		  // one real root, u and v real; avoid cancellation in u
+		  const numT	sq=std::sqrt(D);
+		  const numT	u=std::cbrt(numT(-0.5)*Q+((Q>0.)?-sq:sq));
+		  const numT	v=(u != 0.0)?-P/(numT(3.)*u):numT(0.);
+		  wr[0]=polish(a,b,c,u+v+s);
+		  wr[1]=wr[2]=numT(0.5)*(a-wr[0]);
+		  wi[2]=numT(0.5)*std::sqrt(numT(3.))*std::abs(u-v);
+		  wi[1]=-wi[2];
+		  const numT	scale=std::abs(a)+std::abs(wr[0])+wi[2];
+		  if (std::abs(wr[1]) <= numT(64.)*Precision<numT>::eps()*scale)
+			return false;
+		}
+	  else if (P < 0.0)
+		{
+		  const numT	r=std::sqrt(-P/numT(3.));
+		  numT	t=numT(-0.5)*Q/(r*r*r);
+		  if (t > 1.) t=1.;
+		  if (t < -1.) t=-1.;
+		  const numT	phi=std::acos(t)/numT(3.);
+		  const numT	third=numT(2.)*std::acos(numT(-1.))/numT(3.);
+		  for (integer k=0;k<3;k++)
+			wr[k]=polish(a,b,c,numT(2.)*r*std::cos(phi-k*third)+s);
+		}
+	  else
+		wr[0]=wr[1]=wr[2]=s;	// triple root
+	  return true;
+	}
+
+  private:
+	/** One Newton step on the characteristic polynomial, unless the
+		derivative vanishes (multiple root) or it makes things worse */
+	static numT	polish(const numT& a, const numT& b, const numT& c, const numT& l)
+	{
+	  const numT	f=((l-a)*l+b)*l-c;
+	  const numT	df=(numT(3.)*l-numT(2.)*a)*l+b;
+	  if (df == 0.0) return l;
+	  const numT	n=l-f/df;
+	  const numT	fn=((n-a)*n+b)*n-c;
+	  return (std::abs(fn)<std::abs(f))?n:l;
+	}
+  };
+
+} // end namespace MODEL
+#endif
@@ -21,6 +21,7 @@
 
 #include "utility.h"
 #include <stdexcept>
+#include <vector>
 #include "numerictraits.h"
 #include "numerictypes.h"
 #include "jacobian.h"
@@ -39,8 +40,8 @@ namespace MODEL {
 	typedef typename NT::number	numT;
 	typedef	typename NT::vect	vect;	
 	typedef typename NT::matrix	matrix;
-	typedef typename Jacobian<2*dims>::matrix system;
-	typedef typename Jacobian<2*dims>::vect input;	
+	typedef typename NumericTraits<numT,2*dims>::matrix system;
+	typedef typename NumericTraits<numT,2*dims>::vect input;	
 	typedef typename NumericTraits<complex,dims>::vect response;
 	typedef response cinput;
 	typedef typename NT::vf						vf;
@@ -49,6 +50,11 @@ namespace MODEL {
 	/** For my_sys, for this input parameter */
 	SSA(vf& my_sys, const string& parm);
 
+	/** The relative step used to differentiate the equations to the
+		parameter (central differences, default 1E-4). The jacobian
+		itself is exact if the function supplies it, see ADFunction. */
+	void set_parameter_step(const number& eps) {pareps=eps;}
+
 	/** Set the stationary parameter value around which we will
 		modulate. This will return the number of stable stationary points the
 		system have been able to find. Use get_stat_points to get a
@@ -63,10 +69,17 @@ namespace MODEL {
 	void set_stat_point(const vect& right_there);
 
 	/** get a list of the stationary points */
-	const ScanList<dims,NT>& get_stat_points(void);
+	const ScanList<dims,nelem,NT>& get_stat_points(void);
 	
 	/** get a single response point. For that detailed analysis */
 	response calc_point(const number& omega);
+
+	/** get the response to several sources at the same frequency,
+		like set_dep(source) followed by calc_point(omega) for each of
+		them, but with a single LU decomposition. Meant for noise
+		analysis, with one source per noise term. */
+	std::vector<response> calc_points(const number& omega,
+									  const std::vector<cinput>& sources);
 	
 	/** get a list of responses, equally spaced in a log scale */
 	ScanList<dims,complex> calc_response(const number& from, const
@@ -74,19 +87,19 @@ namespace MODEL {
 										 n);
 
 	/** get a list of responses real,complex, equally spaced in a log scale */
-	ScanList<dims> calc_responseRC(const number& from, const
+	ScanList<dims,nelem,NT> calc_responseRC(const number& from, const
 										 number& to, const counter&
 										 n);
 
 	/** get a list of responses, but this this just the norm, no phase
 		information, please */
-	ScanList<dims> calc_response_norm(const number& from, const
+	ScanList<dims,nelem,NT> calc_response_norm(const number& from, const
 									  number& to, const counter&
 									  n);
 
 	/** get a list of responses, but this this just the phase, no amplitude
 		information, please */
-	ScanList<dims> calc_response_phase(const number& from, const
+	ScanList<dims,nelem,NT> calc_response_phase(const number& from, const
 									  number& to, const counter&
 									  n);
 
@@ -126,7 +139,7 @@ namespace MODEL {
 	bool all_is_well;
 
 	/** The function/jacobian in question */
-	Jacobian<dims>* J; 
+	Jacobian<dims,NT>* J; 
 
 	/** The actual jacobian of the vectorfunction */
 	matrix j; // small j: nice and confusing
@@ -138,7 +151,7 @@ namespace MODEL {
 	RootScan<dims,nelem>* rs;
 
 	/** The list of stationary points */
-	ScanList<dims,nelem> statp;
+	ScanList<dims,nelem,NT> statp;
 
 	/** The stationary point */
 	vect here;
@@ -146,6 +159,9 @@ namespace MODEL {
 	/** The parameter */
 	ParameterP p;
 
+	/** Relative step for the parameter derivative */
+	number pareps;
+
 	/** The linear approximation of the way the equations respond to
 		the input. Also twice as large, but only the top half in used  */
 	input linpar;
@@ -162,9 +178,10 @@ namespace MODEL {
   SSA<dims,nelem,NT>::SSA(vf& my_sys, const string& parm)
   {
 	all_is_well=false;
+	pareps=1E-4;
 	
 	// get the jacobian, copy the function as is
-	J=new Jacobian<dims>(my_sys,1E-6,true);
+	J=new Jacobian<dims,NT>(my_sys,Precision<numT>::sqrt_tolerance(1E-6),true);
 
 	// get the parameter
 	p=&(J->get_function().get_parameter(parm));
@@ -183,9 +200,9 @@ namespace MODEL {
 
 	// statp.print_raw(cout);
 
-	// cerr << "SSA: started number of solutions " << statp.get_data()[0.].size() << endl;
+	// cerr << "SSA: started number of solutions " << statp.count(0.) << endl;
 
-	return statp.get_data()[0.].size();
+	return statp.count(0.);
 	// watch out here: you might find only one (wrong point), because
 	// we are NOT scanning. This is a problem in RootScan.
   }
@@ -194,17 +211,14 @@ namespace MODEL {
   void SSA<dims,nelem,NT>::set_stat_point(const counter& po)
   {
 	// go to correct point
-	if(statp.get_data()[0.].size()>0)
+	if(statp.count(0.)>0)
 	  {
-		// take the first parameter value in the list
-		typename ScanList<dims,nelem>::parpointlist::iterator
-		  getit=statp.get_data()[0].begin();
-	
-		// go to the right value
-		for(counter i=po;i>1;i--) getit++;
+		// take the first parameter value in the list, and go to the
+		// right value
+		const counter getit=statp.find(0.)+((po>1)?po-1:0);
 		
 		// the first value is the point...
-		here=(*getit)[0];
+		here=statp.get_vector(getit,0);
 		
 		// now that we know where we, calculate the approximations
 		calc_dep();
@@ -232,14 +246,14 @@ namespace MODEL {
 	if(all_is_well) {
 	  
 	  put_omega(omega);
-	  LUSolve<2*dims> solA(A,true); // make a copy
+	  LUSolve<2*dims,NumericTraits<numT,2*dims> > solA(A,true); // make a copy
 	
 	  // copy into correct form
 	  input t1 (solA(linpar));
 	  response t2;
 	  for (integer i=0;i<dims;i++)
 		{
-		  t2[i]=t1[i]+I*t1[i+dims];
+		  t2[i]=number(t1[i])+I*number(t1[i+dims]);
 		}
 
 	  return t2;
@@ -247,6 +261,36 @@ namespace MODEL {
 	
   }
 
+  template <integer dims, typename nelem, class NT >
+  std::vector<typename SSA<dims,nelem,NT>::response>
+  SSA<dims,nelem, NT>::calc_points(const number& omega,
+								   const std::vector<cinput>& sources)
+  {
+	std::vector<response> res;
+	if(all_is_well && !sources.empty()) {
+
+	  put_omega(omega);
+	  LUSolve<2*dims,NumericTraits<numT,2*dims> > solA(A,true); // make a copy
+
+	  // the same layout as set_dep
+	  std::vector<input> t1(sources.size(),input(0.));
+	  for (counter s=0;s<counter(sources.size());s++)
+		for (integer i=0;i<dims;i++)
+		  {
+			t1[s][i]=sources[s][i].real();
+			t1[s][dims+i]=sources[s][i].imag();
+		  }
+
+	  solA.solve_many(&t1[0],t1.size());
+
+	  res.resize(sources.size());
+	  for (counter s=0;s<counter(sources.size());s++)
+		for (integer i=0;i<dims;i++)
+		  res[s][i]=number(t1[s][i])+I*number(t1[s][i+dims]);
+	}
+	return res;
+  }
+
   template <integer dims, typename nelem, class NT >
   ScanList<dims,complex>  
   SSA<dims,nelem, NT>::calc_response(const number& from, const
@@ -269,14 +313,14 @@ namespace MODEL {
   }
 
   template <integer dims, typename nelem, class NT >
-  ScanList<dims>
+  ScanList<dims,nelem,NT>
   SSA<dims,nelem, NT>::calc_responseRC(const number& from, const
 									 number& to, const counter&
 									 n)
   {
 	if(all_is_well) {
 
-	  ScanList<dims> res;
+	  ScanList<dims,nelem,NT> res;
 
 	  number scaler=pow(to/from,1./number(n));
 	  for (number omega=from;omega<to;omega*=scaler)
@@ -302,14 +346,14 @@ namespace MODEL {
   }
 
 template <integer dims, typename nelem, class NT >
-  ScanList<dims>
+  ScanList<dims,nelem,NT>
   SSA<dims,nelem, NT>::calc_response_norm(const number& from, const
 										  number& to, const counter&
 										  n)
   {
 	if(all_is_well) {
 	  
-	  ScanList<dims> res;
+	  ScanList<dims,nelem,NT> res;
 
 	  number scaler=pow(to/from,1./number(n));
 	  for (number omega=from;omega<to;omega*=scaler)
@@ -328,14 +372,14 @@ template <integer dims, typename nelem, class NT >
   }
 
   template <integer dims, typename nelem, class NT >
-  ScanList<dims>  
+  ScanList<dims,nelem,NT>  
   SSA<dims,nelem, NT>::calc_response_phase(const number& from, const
 										  number& to, const counter&
 										  n)
   {
 	if(all_is_well) {
 	  
-	  ScanList<dims> res;
+	  ScanList<dims,nelem,NT> res;
 
 	  number scaler=pow(to/from,1./number(n));
 	  for (number omega=from;omega<to;omega*=scaler)
@@ -375,33 +419,25 @@ template <integer dims, typename nelem, class NT >
 	// it is store in linpar
 	linpar=0.; // just to be safe
 
-	// value now
+	// central differences, as in Jacobian::calculate_accurate
 	vf& f=J->get_function();
-	vect    fu ( f(here) );
-
-	number pdp=*p;
-
-	/** \todo this should be modifiable */
-	const number epsilon = 1;
-	number dp=epsilon*abs(pdp);
-		
-	if(dp==0.0) dp = epsilon;		// avoid numerical error	
-	pdp += dp;			// "
-	dp = pdp - *p;		// "
-
-	// get value at new point
-	number oldp=*p;
-	*p=pdp;
+	const number oldp=*p;
 
-	Parameter herep = f.get_parameter("current");
+	number dp=pareps*abs(oldp)/2.;
+	if(dp==0.0) dp = pareps/2.;		// avoid numerical error	
 
-	vect	fudp(f(here));
+	*p=oldp+dp;
+	const number pp=*p;
+	vect	fupdp(f(here));
+	*p=oldp-dp;
+	const number pm=*p;
+	vect	fumdp(f(here));
 	
 	*p=oldp; // restore parameter
 		
 	for(integer i=0;i<dims;i++)
 	  {
-		linpar[i]=(fudp[i]-fu[i])/dp;	
+		linpar[i]=(fupdp[i]-fumdp[i])/(pp-pm);	
 	  }  
   }
   
@@ -20,37 +20,41 @@
 namespace MODEL 
 {
   TickTock::TickTock(TimeFrame& T,time resolution) :
-	TimeFrame(resolution),Cycler(T),resmatch(0) 
+	TimeFrame(resolution),Cycler(T),resmatch(0),stride(1),phase(0),
+	advances(false),master(&T) 
   {
-	// This recalibrates the resolution to a whole fraction of the timeframe
 	time big_dt=T.get_dt();
-	resmatch=counter(big_dt/dt);
-	dt=(big_dt/number(resmatch));
+	if(dt>big_dt)
+	  {
+		// Coarser than the timeframe: a whole multiple of it
+		stride=counter(dt/big_dt+0.5);
+		resmatch=1;
+		dt=big_dt*number(stride);
+	  }
+	else
+	  {
+		// This recalibrates the resolution to a whole fraction of the
+		// timeframe, rounded: 1/0.1 is 9.999... in long double
+		resmatch=counter(big_dt/dt+0.5);
+		if(resmatch<1) resmatch=1;
+		dt=(big_dt/number(resmatch));
+	  }
   }
 
   TimeFrame& 
   TickTock::get_timeframe(void)
   {
-	return *dynamic_cast<TimeFrame*>(get_boss());
+	return *master;
   }
 
   void 
   TickTock::execute(void)
   {
-	// Ooooooh you dirty ... !
-	// But of course it is the ticktock which is responsible,
-	// as it can only be added to a TimeFrame. The TimeFrame,
-	// on the other hand, does not know what kind of objects
-	// is it calling
-	t = dynamic_cast<TimeFrame*>(get_boss())->get_time();
-
-	for(counter repeat=get_resmatch();repeat>0;--repeat)
-	  {
-		tick();
-		// Update time - don't worry:local time only
-		// t+=dt;
-		/** \bug We are programming by coincidence here */
-	  }
+	// The TimeFrame does not know what kind of objects it is
+	// calling, but we know who we were added to
+	if(!due()) return;
+	const time t0=master->get_time();
+	for(counter k=0;k<resmatch;k++) tick_at(t0,k);
   }
   
 }
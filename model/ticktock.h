@@ -32,12 +32,17 @@ namespace MODEL {
   
   /** Base mix-in class for ticktocks: anything that should be called when the time
 	  changes by one tick: odesystem, probes, etc...
-	  \todo Re-evaluate the timing model: there are problems when
-	  TickTock get nested and multiple ticktocks are attached to the
-	  same system. Each one is then evaluated sequentially for the
-	  number of steps needed inside the master timeframe!
+
+	  A TickTock ticks at its own resolution. When that is finer than
+	  the timeframe it is attached to, it ticks get_resmatch() times
+	  per step of the timeframe, and the ticks of all the TickTocks on
+	  one timeframe are interleaved in time order (see
+	  TimeFrame::step()). When it is coarser, it ticks once every
+	  get_stride() steps. A TickTock which does not step() itself (a
+	  probe) still sees the time of each of its ticks in get_time().
  */
   class TickTock : public TimeFrame, public Cycler {
+	friend class TimeFrame;
   public:
 	TickTock(TimeFrame& T,time resolution);
 	
@@ -55,12 +60,44 @@ namespace MODEL {
 		masters TimeFrame's */
 	const counter& get_resmatch(void){return resmatch;}
 
+	/** Return the number of steps of the master per tick: 1 unless the
+		resolution is coarser than the master's */
+	const counter& get_stride(void){return stride;}
+
 	TimeFrame& get_timeframe(void);
 
   private:
-	/** Called by Cowner(In this case, TimeFrame) to make things work */
+	/** Called by Cowner(In this case, TimeFrame) to make things work.
+		TimeFrame::step() does the same from its schedule. */
 	void execute(void);
+
+	/** Should we tick in this step of the master? */
+	bool due(void)
+	{
+	  const bool now=(phase==0);
+	  if(++phase==stride) phase=0;
+	  return now;
+	}
+
+	/** Tick number k in the step of the master starting at t0. A
+		TickTock which steps itself keeps its own time; otherwise it is
+		put at t0+k*dt, not left at t0. */
+	void tick_at(const time& t0, counter k)
+	{
+	  if(k==0) t=t0;
+	  else if(!advances) t=t0+k*dt;
+	  const counter before(steps);
+	  tick();
+	  advances=(steps!=before);
+	}
+
 	counter resmatch;
+	counter stride;
+	counter phase;
+	/** Did the last tick() step()? */
+	bool advances;
+	/** The timeframe we were added to: our boss, as a TimeFrame */
+	TimeFrame* master;
   };
   
 } // end namespace
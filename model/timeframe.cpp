@@ -16,14 +16,18 @@
  ***************************************************************************/
 
 #include "timeframe.h"
+#include "ticktock.h"
+#include <algorithm>
 
 namespace MODEL{
 
+  const time TimeFrame::default_dt=1.E-3;
+
   /** Define a global timeframe */
   TimeFrame	Universal;
 
   TimeFrame::TimeFrame(time resolution, time t_init) 
-	:  t(t_init),dt(resolution) 
+	:  t(t_init),dt(resolution),scheduled(-1),steps(0)
   {
   }
 
@@ -37,11 +41,117 @@ namespace MODEL{
   TimeFrame::step() 
   {
 	time now(t);
-	execute_list(); // Calls cycle for each cylcer
+	if(scheduled!=get_generation()) reschedule();
+
+	// The same as execute_list(), which calls cycle for each cycler,
+	// but without the virtual calls and the dynamic_cast in
+	// TickTock::execute
+	for(counter i=0;i<(counter)schedule.size();)
+	  {
+		const Scheduled s=schedule[i];
+		counter last=s.k+s.n-1;	// the last tick done
+		if(!s.tt) cycle(*s.c);
+		else if(!s.strided || s.tt->due())
+		  {
+			if(s.n==1) s.tt->tick_at(now,s.k);
+			else for(counter k=s.k;k<s.k+s.n;k++)
+			  {
+				s.tt->tick_at(now,k);
+				// the rest of the run may not be ours to do any more
+				if(scheduled!=get_generation()) {last=k; break;}
+			  }
+		  }
+
+		// somebody added or removed a cycler while we were at it
+		if(scheduled!=get_generation()) i=resume(i,last);
+		else ++i;
+	  }
+
 	t=now+dt; // Unecessary precaution. Otherwise we might end up too far.
+	++steps;
 	return t;
   }
 
+  void
+  TimeFrame::reschedule(void)
+  {
+	schedule.clear();
+	const slist<Cycler*>& cyclers=get_list();
+	for(slist<Cycler*>::const_iterator c=cyclers.begin();c!=cyclers.end();++c)
+	  {
+		Scheduled s;
+		s.c=*c;
+		s.tt=dynamic_cast<TickTock*>(*c);
+		s.repeat=(s.tt)?s.tt->get_resmatch():1;
+		s.strided=(s.tt && s.tt->get_stride()>1);
+		s.n=1;
+		for(s.k=0;s.k<s.repeat;s.k++) schedule.push_back(s);
+	  }
+	// in time order; stable, so the same time keeps the list order
+	stable_sort(schedule.begin(),schedule.end(),earlier);
+
+	// and ticks of the same TickTock one after the other in one entry
+	counter last=-1;
+	for(counter i=0;i<(counter)schedule.size();i++)
+	  if(last>=0 && schedule[last].c==schedule[i].c) ++schedule[last].n;
+	  else schedule[++last]=schedule[i];
+	schedule.resize(last+1);
+	scheduled=get_generation();
+  }
+
+  bool
+  TimeFrame::has_tick(const Scheduled& s, counter k, counter repeat)
+  {
+	if((k*s.repeat)%repeat!=0) return false;
+	const counter own=k*s.repeat/repeat;
+	return own>=s.k && own<s.k+s.n;
+  }
+
+  counter
+  TimeFrame::resume(counter i, counter last)
+  {
+	// Done in this step: the entries before i, and entry i up to tick
+	// last, which came at last/repeat of the step.
+	std::vector<Scheduled> old;
+	old.swap(schedule);
+	reschedule();
+	const Scheduled& d=old[i];
+
+	// Go on after the last of those in the new schedule, splitting an
+	// entry if it is half done. At the time of the last tick, the
+	// cyclers before it in the list have had their turn (the list
+	// order has not changed, only cyclers came or went).
+	counter after=0,split=0;
+	for(counter j=0;j<(counter)schedule.size();j++)
+	  {
+		const Scheduled& s=schedule[j];
+		counter m=0;
+		for(;m<s.n;m++)
+		  {
+			const counter a=(s.k+m)*d.repeat,b=last*s.repeat;
+			if(a>b) break;
+			if(a==b && s.c!=d.c)
+			  {
+				bool before=false;
+				for(counter o=0;o<i && !before;o++)
+				  before=(old[o].c==s.c && has_tick(old[o],last,d.repeat));
+				if(!before) break;
+			  }
+		  }
+		if(m>0) {after=j+1; split=(m<s.n)?m:0;}
+	  }
+
+	if(split>0)
+	  {
+		Scheduled rest=schedule[after-1];
+		schedule[after-1].n=split;
+		rest.k+=split;
+		rest.n-=split;
+		schedule.insert(schedule.begin()+after,rest);
+	  }
+	return after;
+  }
+
 }
 
 /*********************************************************************
@@ -21,16 +21,13 @@
 #include "numerictypes.h"
 #include "cowner.h"
 #include "utility.h"
+#include <vector>
 
 namespace MODEL {
 
   /**This class handle timeframes and provides a general way
 	 to keep track of the time dimension in problems (which
 	 is quite often privileged and separate from the others)
-
-	 \bug Sometimes the system jumps back, writing out the wrong
-	 timestamp. Probably this is related to multiple cyclers doing the
-	 same thing. 
 	 */
   class TickTock;
 
@@ -39,7 +36,7 @@ namespace MODEL {
 	friend class TickTock;
   public:
 	/** resolutions */
-	static const	time 	default_dt=1.E-3; 
+	static const	time 	default_dt;
 	
 	TimeFrame(time resolution=default_dt, time t_init=0.);
 	
@@ -56,6 +53,22 @@ namespace MODEL {
 		it thru its paces, calling cycle every time. Then
 		reset the time, and do the same for the next one, until all
 		are happy.
+
+		The cyclers are run from a schedule: an array with every tick
+		of every TickTock in this step, in time order, built when the
+		list of cyclers has changed. Tick k of a TickTock with
+		get_resmatch() R comes at k/R of the step (compared in whole
+		numbers, so there is no rounding); ticks at the same time go in
+		the order of the list. So TickTocks with different resolutions
+		are interleaved, time never runs back between them, and a step
+		costs no list walking and no dynamic_cast, only the tick()
+		calls themselves. A TickTock is ticked directly, without going
+		through cycle(); other cyclers still are.
+
+		When a cycler is added or removed during a step, the schedule
+		is built again and the step goes on after the last tick done:
+		nobody ticks twice, the others lose none of their ticks, and a
+		new one starts with its first tick after that.
 	 */
 	const time&	step();
 
@@ -76,6 +89,39 @@ namespace MODEL {
 	time	t;
 	time	dt;
 
+  private:
+	/** One entry of the schedule: ticks k up to k+n-1 (of repeat per
+		step) of c. tt is 0 for a cycler which is not a TickTock;
+		strided when it does not tick every step */
+	struct Scheduled
+	{
+	  Cycler*		c;
+	  TickTock*		tt;
+	  counter		k;
+	  counter		n;
+	  counter		repeat;
+	  bool			strided;
+	};
+
+	/** Orders the ticks on k/repeat */
+	static bool earlier(const Scheduled& a, const Scheduled& b)
+	{
+	  return a.k*b.repeat < b.k*a.repeat;
+	}
+
+	/** Does s have a tick at k/repeat of the step? */
+	static bool has_tick(const Scheduled& s, counter k, counter repeat);
+
+	void reschedule(void);
+	/** The new schedule, and where to go on in it after tick last
+		of entry i of the old one */
+	counter resume(counter i, counter last);
+
+	std::vector<Scheduled>	schedule;
+	/** The generation of the list the schedule was built from */
+	counter		scheduled;
+	/** The number of steps taken */
+	counter		steps;
   };
 
   /** The global timeframe */
@@ -26,6 +26,7 @@
 #include <map>
 #include <string>
 #include <algorithm>
+#include <vector>
 
 
 namespace MODEL {
@@ -70,7 +71,7 @@ namespace MODEL {
 	/** Overloaded operator(), so the object can be presented as a
 		function. */						
 	vect	operator()(const vect& u)
-	{ vect temp(0.); return function(temp,u); }
+	{ vect temp(0.); function(temp,u); return temp; }
 								
 	/** Implement this function to create the return vector.
 		fu is a reference to where the values should be stored.
@@ -78,6 +79,44 @@ namespace MODEL {
 		Inherited classes should return fu too.*/
 	virtual const vect& function(vect& fu,const vect& u) = 0;	
 
+	/** Override this if you know the jacobian j[i][j]=df[i]/du[j]
+		in closed form, and return true. Jacobian (and so NewtonRoot,
+		RootScan, SSA and the stochastic integrators) will then use it
+		instead of finite differences. The default returns false,
+		meaning "please differentiate numerically". */
+	virtual bool jacobian(matrix&, const vect&) {return false;}
+
+	/** The function at n points at once: fu[r]=f(u[r]). Jacobian
+		hands all its columns over in one call. The default just calls
+		function() n times; override it if the points can be done
+		together (one dispatch, loops the compiler can vectorise). */
+	virtual void function_batch(vect* fu, const vect* u, counter n)
+	{
+	  for (counter r=0;r<n;r++) function(fu[r],u[r]);
+	}
+
+	/** The function for n points at once, stored per component
+		(structure of arrays): component i of point r is u[i*n+r], and
+		the result goes to fu in the same layout. EnsembleODESystem
+		calls this. The default copies the points into vects, a block
+		at a time, and calls function_batch(); override it with plain
+		loops over r, which the compiler can vectorise, to make
+		ensembles fast. */
+	virtual void function_ensemble(numT* fu, const numT* u, counter n)
+	{
+	  const counter	block=(n<64)?n:64;
+	  vector<vect>	x(block),f(block);
+	  for (counter r0=0;r0<n;r0+=block)
+		{
+		  const counter m=(n-r0<block)?(n-r0):block;
+		  for (counter r=0;r<m;r++)
+			for (integer i=0;i<dims;i++) x[r][i]=u[i*n+r0+r];
+		  function_batch(&f[0],&x[0],m);
+		  for (counter r=0;r<m;r++)
+			for (integer i=0;i<dims;i++) fu[i*n+r0+r]=f[r][i];
+		}
+	}
+
 	void define_parameter(const string& name, number&
 						  p){parlist[name]=&p;}
 
@@ -102,6 +141,28 @@ namespace MODEL {
 	  return *(found->second);
 	}
 
+	/** The handle of a parameter: its position in the parameter list.
+		Looking it up by handle saves the string compares, and it stays
+		valid for clones (which define the same names). */
+	ParameterHandle get_handle(const string& name) const
+	{
+	  map<string,number*>::const_iterator  found=parlist.find(name);
+
+	  if (found==parlist.end()) throw std::logic_error("VectorFunction::Parameter not found");
+
+	  return distance(parlist.begin(),found);
+	}
+
+   	number& get_parameter(ParameterHandle h) const
+	{
+	  if (h<0 || h>=(ParameterHandle)parlist.size()) throw
+						std::logic_error("VectorFunction::Parameter not found");
+
+	  map<string,number*>::const_iterator  here=parlist.begin();
+	  advance(here,h);
+	  return *(here->second);
+	}
+
   public:
  	map<string,number*>& get_parlist(void)
 	{
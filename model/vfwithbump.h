@@ -35,6 +35,7 @@ namespace MODEL {
 	  typedef VectorFunction<dims,nelem,NT> base;
 	  typedef base vf;
 	  typedef typename base::vect vect;
+	  typedef typename base::matrix matrix;
 	  
   public:
 	/** Just create a possibility to add bumps on top of an existing
@@ -72,6 +73,7 @@ namespace MODEL {
 	  if(runner==p.end()) {return f->function(fu,u); }
 	  
 	  // Otherwise
+	  const nelem radius=Precision<nelem>::sqrt_tolerance(1.5*NewtonRoot<dims,nelem,NT>::tolerancex);
 	  nelem	factor=1.;
 	  while(runner!=p.end())
 		{
@@ -85,7 +87,7 @@ namespace MODEL {
 		  // hypersphere of zeroes
 		  /** \todo It would be even better to make it a
 			  hyperellipsoid instead of a sphere */
-		  number distance=abs(length(bump)-1.5*NewtonRoot<dims,nelem,NT>::tolerancex)/length(bump);   
+		  nelem distance=abs(length(bump)-radius)/length(bump);   
 		  					
 		  factor /= distance; // close to zero goes to zero
 		  ++runner;
@@ -95,6 +97,62 @@ namespace MODEL {
 
 	  return fu;
 	}	
+
+	/** Hand the points to the function underneath in one go, and put
+		the bumps on afterwards */
+	virtual void function_batch(vect* fu, const vect* u, counter n)
+	{
+	  f->function_batch(fu,u,n);
+	  if(p.empty()) return;
+	  const nelem radius=Precision<nelem>::sqrt_tolerance(1.5*NewtonRoot<dims,nelem,NT>::tolerancex);
+	  for (counter r=0;r<n;r++)
+		{
+		  nelem	factor=1.;
+		  for (typename vector<vect>::iterator runner=p.begin();runner!=p.end();++runner)
+			{
+			  vect bump(u[r]);
+			  bump-=(*runner);
+			  nelem distance=abs(length(bump)-radius)/length(bump);   
+			  factor /= distance;
+			}
+		  fu[r]*=(1+factor);
+		}
+	}
+
+	/** If the function underneath knows its jacobian, so do we:
+		with g=(1+factor).f, dg/du = (1+factor).df/du + f.dfactor/du,
+		and every bump contributes
+		dfactor/du = -factor.sign(L-R).R.(u-p)/(d.L^3),
+		where L is the distance to the bump, R its radius and d the
+		distance used in function(). */
+	virtual bool jacobian(matrix& j, const vect& u)
+	{
+	  if (!f->jacobian(j,u)) return false;
+
+	  typename vector<vect>::iterator	runner(p.begin());
+	  if(runner==p.end()) return true;
+
+	  const nelem radius=Precision<nelem>::sqrt_tolerance(1.5*NewtonRoot<dims,nelem,NT>::tolerancex);
+	  nelem	factor=1.;
+	  vect	dfactor(0.);	// sum of dd/du / d, times -factor later
+	  while(runner!=p.end())
+		{
+		  vect bump(u);
+		  bump-=(*runner);
+		  const nelem L=length(bump);
+		  const nelem distance=abs(L-radius)/L;
+		  factor /= distance;
+		  const nelem sign=(L>radius)?1.:-1.;
+		  for (integer k=0;k<dims;k++) dfactor[k]+=sign*radius*bump[k]/(distance*L*L*L);
+		  ++runner;
+		}
+	  vect	fu(0.);
+	  f->function(fu,u);
+	  for (integer i=0;i<dims;i++)
+		for (integer k=0;k<dims;k++)
+		  j[i][k]=(1+factor)*j[i][k]-fu[i]*factor*dfactor[k];
+	  return true;
+	}
 		
   private:
 	vf*		f;
@@ -0,0 +1,228 @@
+/***************************************************************************
+                          benchmark.cpp  -  timing of the numerical kernels
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Times the kernels that do all the work: LU decomposition,
+	eigenvalues, the jacobian and integration steps. "make bench"
+	builds this twice, with and without MODEL_CHECK_BOUNDS, and runs
+	both, so you can see what the bounds checking costs. It only uses
+	headers, and must not link libMODEL.a: that is compiled without
+	MODEL_CHECK_BOUNDS.
+*/
+
+#include "model/vectorfunction.h"
+#include "model/integrator.h"
+#include "model/lusolve.h"
+#include "model/eigenvalues.h"
+#include "model/jacobian.h"
+#include "model/adfunction.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+using namespace MODEL;
+
+const integer	D=24;
+typedef NumericTraits<number,D>	NT;
+typedef NT::vect	vect;
+typedef NT::matrix	matrix;
+
+/** A ring of coupled damped oscillators: dense enough to be a fair
+	test, simple enough not to dominate the timing itself. */
+class Ring : public VectorFunction<D>
+{
+public:
+  typedef VectorFunction<D>	base;
+
+  Ring() : k(0.3) {}
+  base*	clone(void) const {return new Ring(*this);}
+
+  const vect& function(vect& f, const vect& u)
+  {
+	for (integer i=0;i<D;i++)
+	  f[i]=-u[i]+k*(u[(i+1)%D]-u[(i+D-1)%D])+k*u[i]*u[(i+D/2)%D];
+	return f;
+  }
+
+protected:
+  numT	k;
+};
+
+/** The same ring, with its jacobian written out */
+class RingJ : public Ring
+{
+public:
+  base*	clone(void) const {return new RingJ(*this);}
+
+  bool	jacobian(matrix& j, const vect& u)
+  {
+	j=matrix(0.);
+	for (integer i=0;i<D;i++)
+	  {
+		j[i][i]=-1.+k*u[(i+D/2)%D];
+		j[i][(i+1)%D]+=k;
+		j[i][(i+D-1)%D]-=k;
+		j[i][(i+D/2)%D]+=k*u[i];
+	  }
+	return true;
+  }
+};
+
+/** The same ring, doing a whole batch of points in one call */
+class RingB : public Ring
+{
+public:
+  base*	clone(void) const {return new RingB(*this);}
+
+  void	function_batch(vect* f, const vect* u, counter n)
+  {
+	for (counter r=0;r<n;r++)
+	  for (integer i=0;i<D;i++)
+		f[r][i]=-u[r][i]+k*(u[r][(i+1)%D]-u[r][(i+D-1)%D])+k*u[r][i]*u[r][(i+D/2)%D];
+  }
+};
+
+/** And once more, differentiated automatically */
+class RingAD : public ADFunction<RingAD,D>
+{
+public:
+  RingAD() : k(0.3) {}
+  base*	clone(void) const {return new RingAD(*this);}
+
+  template <class V>
+  const V& evaluate(V& f, const V& u)
+  {
+	for (integer i=0;i<D;i++)
+	  f[i]=-u[i]+k*(u[(i+1)%D]-u[(i+D-1)%D])+k*u[i]*u[(i+D/2)%D];
+	return f;
+  }
+
+private:
+  numT	k;
+};
+
+/** A well conditioned test matrix */
+void fill(matrix& m)
+{
+  for (integer i=0;i<D;i++)
+	for (integer j=0;j<D;j++)
+	  m[i][j]=1./(i+j+1.)+((i==j)?D:0.)+0.01*(i-j);
+}
+
+/** Runs f n times and reports the time per run */
+template <class F>
+void time_it(const char* name, long n, F f)
+{
+  std::chrono::steady_clock::time_point start=std::chrono::steady_clock::now();
+  number check=0.;
+  for (long i=0;i<n;i++) check+=f();
+  std::chrono::duration<double,std::micro> us=std::chrono::steady_clock::now()-start;
+  std::cout << std::setw(20) << std::left << name
+			<< std::setw(12) << std::right << std::fixed << std::setprecision(3)
+			<< us.count()/n << " us/run   (check "
+			<< std::setprecision(6) << (double)check << ")" << std::endl;
+}
+
+int main()
+{
+#ifdef MODEL_CHECK_BOUNDS
+  std::cout << "Bounds checking: on  (dims=" << D << ")" << std::endl;
+#else
+  std::cout << "Bounds checking: off (dims=" << D << ")" << std::endl;
+#endif
+
+  time_it("LU decompose+solve",20000,[]()
+		  {
+			matrix m; fill(m);
+			vect b(1.);
+			LUSolve<D> lu(m);
+			lu.solve(b);
+			return b[0];
+		  });
+
+  time_it("eigenvalues",2000,[]()
+		  {
+			matrix m; fill(m);
+			Eigenvalues<D> ev(m);
+			return ev.real()[0];
+		  });
+
+  // the sizes most models have: closed forms, see smallmatrix.h
+  typedef NumericTraits<number,2>::matrix	matrix2;
+  time_it("LU 2x2",1000000,[]()
+		  {
+			matrix2 m; m[0][0]=2.; m[0][1]=0.5; m[1][0]=-1.; m[1][1]=3.;
+			NumericTraits<number,2>::vect b(1.);
+			LUSolve<2> lu(m);
+			lu.solve(b);
+			return b[0];
+		  });
+
+  time_it("eigenvalues 2x2",1000000,[]()
+		  {
+			matrix2 m; m[0][0]=2.; m[0][1]=0.5; m[1][0]=-1.; m[1][1]=3.;
+			Eigenvalues<2> ev(m);
+			return ev.imag()[0];
+		  });
+
+  Ring r;
+  time_it("jacobian",20000,[&r]()
+		  {
+			vect u(0.1);
+			Jacobian<D> J(r);
+			matrix m=J.calculate_accurate(u);
+			return m[0][0];
+		  });
+
+  RingB rb;
+  time_it("jacobian (batched)",20000,[&rb]()
+		  {
+			vect u(0.1);
+			Jacobian<D> J(rb);
+			matrix m=J.calculate_accurate(u);
+			return m[0][0];
+		  });
+
+  RingJ rj;
+  time_it("jacobian (analytic)",20000,[&rj]()
+		  {
+			vect u(0.1);
+			Jacobian<D> J(rj);
+			matrix m=J.calculate_accurate(u);
+			return m[0][0];
+		  });
+
+  RingAD rad;
+  time_it("jacobian (dual)",20000,[&rad]()
+		  {
+			vect u(0.1);
+			Jacobian<D> J(rad);
+			matrix m=J.calculate_accurate(u);
+			return m[0][0];
+		  });
+
+  time_it("rk4 steps",200,[&r]()
+		  {
+			IRungeKutta<D> rk(r,r);
+			MODEL::time dt=1e-3;
+			vect u(0.5);
+			for (integer i=0;i<1000;i++) rk.step(u,dt);
+			return u[0];
+		  });
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+/***************************************************************************
+                          probe2text.cpp  -  binary probe output to text
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Turns the output of a BinaryProbeWriter into the gnuplot text a
+	Probe writes by default, byte for byte:
+
+	probe2text run.bin > run.dat
+	probe2text run.bin run.dat
+
+	It has to be built with the number type of the program that wrote
+	the file (see --enable-double and --enable-float).
+*/
+
+#include "model/probe.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace MODEL;
+
+int main(int argc, char* argv[])
+{
+  if (argc<2 || argc>3)
+	{
+	  cerr << "usage: probe2text binaryfile [textfile]" << endl;
+	  return 1;
+	}
+
+  ifstream in(argv[1],ios::in|ios::binary);
+  if (!in)
+	{
+	  cerr << "probe2text: cannot open " << argv[1] << endl;
+	  return 1;
+	}
+
+  try 
+	{
+	  BinaryProbeReader reader(in);
+	  TextProbeWriter* writer=(argc==3)?new TextProbeWriter(argv[2]):new TextProbeWriter(cout);
+	  vector<number> record;
+	  while (reader.read(record)) writer->write(&record[0],record.size());
+	  delete writer;
+	}
+  catch (std::exception& e)
+	{
+	  cerr << "probe2text: " << e.what() << endl;
+	  return 1;
+	}
+  return 0;
+}
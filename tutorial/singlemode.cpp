@@ -222,8 +222,16 @@ int main (void)
 		// set the param, this also find solutions
 		small.set_stat_point(); // take the first point
 	  else // find one in the list
-		small.set_stat_point(*solutions.select(RootScan< 2
-											   >::stable).get_solution(j).begin()->begin());
+		{
+		  ScanList<2>::parpointlist there=solutions.select(RootScan< 2
+														   >::stable).get_solution(j);
+		  if(there.empty())
+			{
+			  cerr << "No stable solution after " << j << " in the scan." << endl;
+			  return 1;
+			}
+		  small.set_stat_point(*there.begin()->begin());
+		}
 
 	  bode+=small.calc_response_norm(0.1,1e6,250); // add the response
 	}
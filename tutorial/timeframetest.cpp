@@ -0,0 +1,181 @@
+/***************************************************************************
+                          timeframetest.cpp  -  ticks when cyclers come and go
+                             -------------------
+    begin                : Sun Oct 18 2026
+    copyright            : (C) 2026 by Michael Peeters
+    email                : Michael.Peeters@vub.ac.be
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+/** Checks the schedule of TimeFrame::step() (make check): TickTocks
+	of different resolutions are interleaved in time order, coarse ones
+	tick every get_stride() steps, probes on a TickTock which steps
+	itself tick once per step of it, and every TickTock gets all its
+	ticks, and none twice, when one stops itself or starts another one
+	in the middle of a step. Exits with 1 on a failure.
+*/
+
+#include "model/timeframe.h"
+#include "model/ticktock.h"
+
+#include <iostream>
+#include <vector>
+
+using namespace MODEL;
+
+/** Writes down the time of every tick, and can stop itself or start
+	another TickTock at one of them */
+class Recorder : public TickTock
+{
+public:
+  Recorder(TimeFrame& T, MODEL::time res, std::vector<MODEL::time>* l=NULL)
+	: TickTock(T,res), stopat(-1), startat(-1), other(NULL), log(l) {}
+  ~Recorder() {delete other;}
+
+  virtual void tick()
+  {
+	const counter n=times.size();
+	times.push_back(get_time());
+	if(log) log->push_back(get_time());
+	if(n==stopat) get_timeframe().stop(*this);
+	if(n==startat) other=new Recorder(get_timeframe(),get_dt());
+  }
+
+  /** the tick (counted from 0) at which to stop or start */
+  counter stopat,startat;
+  Recorder* other;
+  std::vector<MODEL::time> times;
+  /** the ticks of all the Recorders sharing it, in the order they came */
+  std::vector<MODEL::time>* log;
+};
+
+static int failures=0;
+
+/** The ticks were at t[0..n), give or take the rounding of a time
+	which was summed up */
+static void expect(const char* what, const std::vector<MODEL::time>& got,
+				   const MODEL::time* t, counter n)
+{
+  bool ok=((counter)got.size()==n);
+  for(counter i=0;ok && i<n;i++) ok=(abs(got[i]-t[i])<=1E-9*(1.+abs(t[i])));
+  if(ok) return;
+  ++failures;
+  cerr << what << ": ticks at";
+  for(counter i=0;i<(counter)got.size();i++) cerr << " " << got[i];
+  cerr << ", expected";
+  for(counter i=0;i<n;i++) cerr << " " << t[i];
+  cerr << endl;
+}
+
+static void expect(const char* what, const Recorder& r, const MODEL::time* t, counter n)
+{
+  expect(what,r.times,t,n);
+}
+
+int main()
+{
+  const MODEL::time all[]={0.,0.5,1.,1.5,2.,2.5};
+  const MODEL::time once[]={0.};
+
+  // different resolutions are interleaved in time order, and a coarse
+  // one ticks every other step
+  {
+	TimeFrame T(1.);
+	std::vector<MODEL::time> log;
+	Recorder A(T,0.5,&log);
+	Recorder B(T,0.25,&log);
+	Recorder C(T,2.,&log);
+	for(integer s=0;s<4;s++) T.step();
+	const MODEL::time halves[]={0.,0.5,1.,1.5,2.,2.5,3.,3.5};
+	expect("A at 0.5",A,halves,8);
+	const MODEL::time quarters[]={0.,0.25,0.5,0.75,1.,1.25,1.5,1.75,
+								  2.,2.25,2.5,2.75,3.,3.25,3.5,3.75};
+	expect("B at 0.25",B,quarters,16);
+	const MODEL::time twos[]={0.,2.};
+	expect("C at 2",C,twos,2);
+	if(C.get_stride()!=2 || C.get_resmatch()!=1)
+	  {
+		++failures;
+		cerr << "C: stride " << C.get_stride() << ", resmatch "
+			 << C.get_resmatch() << ", expected 2 and 1" << endl;
+	  }
+	// C, B, A at 0; B at 0.25; B, A at 0.5; ...
+	const MODEL::time order[]={0.,0.,0.,0.25,0.5,0.5,0.75,
+							   1.,1.,1.25,1.5,1.5,1.75,
+							   2.,2.,2.,2.25,2.5,2.5,2.75,
+							   3.,3.,3.25,3.5,3.5,3.75};
+	expect("in time order",log,order,26);
+  }
+
+  // probes on a TickTock which steps itself (as an ODESystem does)
+  // tick once for every step of it, at its resolution or a multiple
+  // of it, and their times never run back. 1/0.1 is not a whole
+  // number in binary, and should still give ten ticks per step.
+  {
+	TimeFrame T(1.);
+	TickTock X(T,0.1);
+	std::vector<MODEL::time> log;
+	Recorder P(X,0.1,&log);
+	Recorder Q(X,0.2,&log);
+	for(integer s=0;s<2;s++) T.step();
+	MODEL::time tenths[20],fifths[10];
+	for(integer i=0;i<20;i++) tenths[i]=0.1*i;
+	for(integer i=0;i<10;i++) fifths[i]=0.2*i;
+	expect("P at 0.1",P,tenths,20);
+	expect("Q at 0.2",Q,fifths,10);
+	for(counter i=1;i<(counter)log.size();i++)
+	  if(log[i]<log[i-1])
+		{
+		  ++failures;
+		  cerr << "time runs back from " << log[i-1] << " to " << log[i] << endl;
+		}
+  }
+
+  // B stops itself after A has ticked, or before: A keeps its tick at
+  // 0.5 either way
+  for(integer order=0;order<2;order++)
+	{
+	  TimeFrame T(1.);
+	  Recorder* first=new Recorder(T,0.5);
+	  Recorder* second=new Recorder(T,0.5);
+	  Recorder& A(order?*first:*second);
+	  Recorder& B(order?*second:*first);
+	  B.stopat=0;
+	  for(integer s=0;s<3;s++) T.step();
+	  expect(order?"B stops after A":"B stops before A",A,all,6);
+	  expect("B",B,once,1);
+	  delete first;
+	  delete second;
+	}
+
+  // a run of ticks of one TickTock stops when it stops itself
+  {
+	TimeFrame T(1.);
+	Recorder A(T,0.5);
+	A.stopat=0;
+	for(integer s=0;s<3;s++) T.step();
+	expect("A stops itself",A,once,1);
+  }
+
+  // starting another one does not tick A twice or skip its ticks
+  {
+	TimeFrame T(1.);
+	Recorder A(T,0.5);
+	A.startat=0;
+	for(integer s=0;s<3;s++) T.step();
+	expect("A starts C",A,all,6);
+	const MODEL::time rest[]={0.5,1.,1.5,2.,2.5};
+	expect("C",*A.other,rest,5);
+  }
+
+  if(failures==0) cout << "timeframetest: all passed" << endl;
+  return (failures==0)?0:1;
+}